@@ -4,16 +4,62 @@
 // WiFi Configuration
 #define WIFI_SSID "Fox"
 #define WIFI_PASSWORD "12345678"
-#define WIFI_TIMEOUT_MS 10000
-#define WIFI_RECONNECT_INTERVAL_MS 30000
+#define WIFI_TIMEOUT_MS 10000          // One connection attempt
+#define WIFI_BACKOFF_MIN_MS 1000       // Wait after the first failure, doubling per retry
+#define WIFI_BACKOFF_MAX_MS 30000
+
+// Fast reconnect: associate straight to the last access point (BSSID and
+// channel cached in flash) before falling back to a full scan
+#define WIFI_FAST_CONNECT 1
+#define WIFI_FAST_TIMEOUT_MS 3000      // Give up on the cached AP and scan after this
+#define WIFI_REUSE_LEASE 1             // Also skip DHCP by reusing the cached lease
+#define WIFI_LEASE_CHECK_MS 5000       // Nothing received this long on a reused lease: forget it, scan and DHCP
+#define WIFI_CACHE_EEPROM_OFFSET 0
+
+// Optional fixed address instead of DHCP (both connect paths)
+// #define WIFI_STATIC_IP 192, 168, 43, 100
+// #define WIFI_STATIC_GATEWAY 192, 168, 43, 1
+// #define WIFI_STATIC_SUBNET 255, 255, 255, 0
+// #define WIFI_STATIC_DNS 192, 168, 43, 1
 
 // UDP Configuration
 #define F1_UDP_PORT 20777
 #define PCARS_UDP_PORT 5606
 #define PCARS_FORWARDER_PORT 20778
-#define UDP_BUFFER_SIZE 2048
+
+// UDP listeners, one socket each; every datagram is tagged with its source
+#define UDP_SOURCE_F1 0
+#define UDP_SOURCE_PCARS 1              // Game's own packets on PCARS_UDP_PORT
+#define UDP_SOURCE_PCARS_FORWARDER 2    // pcars_forwarder.py frames or JSON on PCARS_FORWARDER_PORT
+#define UDP_SOURCE_COUNT 3
+
+// Most datagrams drained from one listener per loop, so a flood can't stall
+// buttons and rendering
+#define UDP_DRAIN_LIMIT 32
+
+// Received datagrams queued per game between the receive callback and loop().
+// When a ring is full the oldest datagram is dropped.
+#ifndef UDP_RING_SLOTS
+    #ifdef ESP8266_BOARD
+        #define UDP_RING_SLOTS 4
+    #else
+        #define UDP_RING_SLOTS 8
+    #endif
+#endif
+// With F1_FIELD_TABLE, the F1 packets carrying every car queue in a ring of
+// their own with full-size slots. The game sends one of each per frame, so
+// fewer slots cover the same time.
+#ifndef F1_TABLE_RING_SLOTS
+    #define F1_TABLE_RING_SLOTS 4
+#endif
 #define UDP_TIMEOUT_MS 100
 
+// Sender pinning: each listener follows the first valid sender (IP and port)
+// and rejects the others until it has been silent this long
+#define SENDER_PIN_TIMEOUT_MS 2000
+// Optional: only ever accept telemetry from this host
+// #define SENDER_PIN_IP 192, 168, 43, 10
+
 // Display Configuration (SH1106 128x64)
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
@@ -47,19 +93,101 @@
 #define PAGE_SETTINGS 3
 #define MAX_PAGES 4
 
+// ESP32 telemetry task publishes a snapshot at least this often even without
+// new data, so counters and the data timeout reach the render task
+#define DISPLAY_REFRESH_MS 100
+
+// Most 8x8 tiles (8 bytes each) sent per display flush step. ESP8266 drains
+// a frame over several loop passes (~1 ms per tile at 100 kHz) so I2C never
+// holds up packet intake for long; ESP32 renders in its own task and sends
+// the whole frame at once.
+#ifdef ESP8266_BOARD
+    #define DISPLAY_FLUSH_TILES 4
+#else
+    #define DISPLAY_FLUSH_TILES 128
+#endif
+
+// Pre-render the speed and lap pages' labels and frames, and the large-font
+// digits, at startup; a frame then starts from a copy of its page's chrome
+// and blits the digits instead of rasterizing them. Costs ~2.8KB of RAM on
+// SH1106 (two 1KB frames and the glyphs), ~1.8KB on SSD1306.
+#ifndef DISPLAY_RENDER_CACHE
+    #define DISPLAY_RENDER_CACHE 1
+#endif
+
+// RPM bar and shift cue. The bar spans 0 to the rev limiter the game reports
+// in car status; RPM_BAR_DEFAULT_MAX stands in until it has. The cue comes on
+// once the RPM, carried forward by the measured receive-to-panel latency,
+// reaches SHIFT_LIGHT_RPM_PERCENT of the limiter - or, before the limiter is
+// known, F1's rev lights reach SHIFT_LIGHT_REV_LIGHTS_PERCENT.
+#define RPM_BAR_DEFAULT_MAX 8000
+#define SHIFT_LIGHT_RPM_PERCENT 96
+#define SHIFT_LIGHT_REV_LIGHTS_PERCENT 90
+#define SHIFT_LIGHT_HYSTERESIS 3         // Percent of the shift point the prediction must fall back before the cue goes off
+#define SHIFT_LIGHT_MAX_LEAD_MS 150      // Never look further ahead than this, whatever the measured latency
+#define SHIFT_LIGHT_SAMPLE_GAP_MS 250    // Samples further apart than this start the RPM slope over
+
+// ESP32 task layout: receive and parse on the WiFi core, render on the other.
+// ESP8266 runs both sides in loop().
+#ifndef ESP8266_BOARD
+    #define TELEMETRY_TASK_CORE 0
+    #define TELEMETRY_TASK_PRIORITY 2
+    #define TELEMETRY_TASK_STACK_SIZE 8192
+    #define RENDER_TASK_CORE 1
+    #define RENDER_TASK_PRIORITY 1
+    #define RENDER_TASK_STACK_SIZE 8192
+#endif
+
 // Game Types
 #define GAME_F1 0
 #define GAME_PCARS 1
+#define GAME_COUNT 2
+#define GAME_AUTO -1    // No game pinned: GameSelector follows the traffic
 
-// F1 2020 Packet Constants
+// Automatic game selection: every listener's datagrams are header-checked and
+// counted, and the game sending the most valid packets is decoded. A game
+// takes over once it sends at least GAME_SWITCH_MIN_PACKETS per window and
+// GAME_SWITCH_RATIO times the selected game's count, for GAME_SWITCH_WINDOWS
+// windows in a row. SELECT on the settings page pins a game instead, until
+// the next press.
+#define GAME_RATE_WINDOW_MS 500
+#define GAME_SWITCH_MIN_PACKETS 5
+#define GAME_SWITCH_RATIO 2
+#define GAME_SWITCH_WINDOWS 3
+
+// F1 Packet Constants (per-year sizes live in src/f1_layouts.h)
 #define F1_PACKET_FORMAT_2020 2020
 #define F1_PACKET_ID_CAR_TELEMETRY 6
 #define F1_MAX_CARS 22
-#define F1_PACKET_HEADER_SIZE 25
-#define F1_CAR_TELEMETRY_SIZE 60
+
+// A frame further behind the newest one seen than this is a game rewind
+// (flashback, restart), not a late datagram, and resynchronises the sequence
+#define F1_SEQUENCE_REWIND_FRAMES 60
+
+// Keep every car's telemetry and lap position in F1FieldTable, not just the
+// player's. Lap data and car telemetry then need F1_TABLE_PACKET_SIZE
+// (1352 byte) buffers instead of 128 byte ones: F1_TABLE_RING_SLOTS in the
+// receive ring plus three in F1Receiver, about 9.5KB with the defaults, so
+// it's off on ESP8266 by default.
+#ifndef F1_FIELD_TABLE
+    #ifdef ESP8266_BOARD
+        #define F1_FIELD_TABLE 0
+    #else
+        #define F1_FIELD_TABLE 1
+    #endif
+#endif
+
+// PCARS2 mPacketNumber counts every packet type, so a late datagram can be a few
+// hundred numbers behind; further back than this means the game restarted
+#define PCARS_SEQUENCE_REWIND_PACKETS 1024
 
 // Debug
 #define DEBUG_SERIAL 1
-#define DEBUG_UDP 1  // Enable UDP packet debugging
+// Per-packet serial lines from the receive path and parsers. Off by default:
+// they go out for every datagram, and the cores' Serial.printf allocates for
+// lines over 64 bytes, so with them on the hot path is no longer heap-free.
+#ifndef DEBUG_UDP
+    #define DEBUG_UDP 0
+#endif
 
 #endif // CONFIG_H
\ No newline at end of file
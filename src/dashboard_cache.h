@@ -0,0 +1,165 @@
+#ifndef DASHBOARD_CACHE_H
+#define DASHBOARD_CACHE_H
+
+#include <Arduino.h>
+#include <string.h>
+
+// Pre-rendered parts of the hot pages, built once at startup from whatever
+// the panel's own fonts and primitives draw:
+//  - chrome: a full frame per cached page holding its static labels and
+//    frames, copied in instead of clearing the buffer
+//  - glyphs: the large-font digits, N and R as column bytes, ORed into the
+//    frame instead of rasterizing the font again
+//
+// Frames use the layout both U8g2's full buffer and Adafruit_SSD1306 share:
+// byte (y / 8) * Width + x holds 8 vertical pixels, bit 0 at the top. A glyph
+// is stored for the baseline it was rendered at, so it can be blitted at any
+// x but only at baselines a whole number of byte rows away.
+template<int Width, int Height>
+class DashboardCache {
+public:
+    enum {
+        FRAME_BYTES = Width * Height / 8,
+        FRAME_ROWS = Height / 8,
+        CHROME_PAGES = 2,         // PAGE_SPEED_GEAR and PAGE_LAP_FUEL
+        GLYPH_COUNT = 12,         // 0-9, N, R
+        GLYPH_MAX_WIDTH = 16,
+        GLYPH_MAX_ROWS = 4
+    };
+
+    DashboardCache() : chromeValid(), glyphsValid(false), glyphBaseline(0), glyphRow(0), glyphRowEnd(0), glyphRows(0) {
+    }
+
+    // -1 for characters that aren't cached
+    static int glyphIndex(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c == 'N') {
+            return 10;
+        }
+        if (c == 'R') {
+            return 11;
+        }
+        return -1;
+    }
+
+    static char glyphChar(int index) {
+        return index < 10 ? '0' + index : (index == 10 ? 'N' : 'R');
+    }
+
+    void saveChrome(uint8_t page, const uint8_t* frame) {
+        memcpy(chrome[page], frame, FRAME_BYTES);
+        chromeValid[page] = true;
+    }
+
+    bool loadChrome(uint8_t page, uint8_t* frame) const {
+        if (page >= CHROME_PAGES || !chromeValid[page]) {
+            return false;
+        }
+        memcpy(frame, chrome[page], FRAME_BYTES);
+        return true;
+    }
+
+    // Building the glyphs takes two passes over frames holding one glyph
+    // each, drawn at x = 0: the first finds the byte rows any of them touch,
+    // the second copies those rows out
+    void beginGlyphs(int16_t baseline) {
+        glyphsValid = false;
+        glyphBaseline = baseline;
+        glyphRow = FRAME_ROWS;
+        glyphRowEnd = 0;
+        glyphRows = 0;
+    }
+
+    void measureGlyph(const uint8_t* frame) {
+        for (uint8_t row = 0; row < FRAME_ROWS; row++) {
+            for (uint8_t x = 0; x < GLYPH_MAX_WIDTH; x++) {
+                if (frame[row * Width + x]) {
+                    glyphRow = min(glyphRow, row);
+                    glyphRowEnd = max(glyphRowEnd, (uint8_t)(row + 1));
+                    break;
+                }
+            }
+        }
+        glyphRows = glyphRowEnd > glyphRow ? glyphRowEnd - glyphRow : 0;
+    }
+
+    // advance: how far the font moves x after this glyph. False if the glyph
+    // doesn't fit or came out blank (a font without the character).
+    bool saveGlyph(uint8_t index, const uint8_t* frame, int16_t advance) {
+        if (glyphRows > GLYPH_MAX_ROWS || advance < 0 || advance > GLYPH_MAX_WIDTH) {
+            return false;
+        }
+
+        Glyph& glyph = glyphs[index];
+        glyph.advance = advance;
+        glyph.columns = 0;
+        for (uint8_t row = 0; row < glyphRows; row++) {
+            const uint8_t* source = frame + (glyphRow + row) * Width;
+            memcpy(glyph.bits[row], source, GLYPH_MAX_WIDTH);
+            for (uint8_t x = glyph.columns; x < GLYPH_MAX_WIDTH; x++) {
+                if (source[x]) {
+                    glyph.columns = x + 1;
+                }
+            }
+        }
+        return glyph.columns > 0;
+    }
+
+    void endGlyphs() {
+        glyphsValid = true;
+    }
+
+    // Draws text left-aligned at (x, baseline). False, with nothing drawn, if
+    // a character isn't cached or the baseline isn't row-aligned with the
+    // cached one; the caller draws it the slow way.
+    bool blit(uint8_t* frame, int16_t x, int16_t baseline, const char* text) const {
+        int16_t shift = baseline - glyphBaseline;
+        if (!glyphsValid || shift % 8 != 0) {
+            return false;
+        }
+        int16_t row = glyphRow + shift / 8;
+        if (row < 0 || row + glyphRows > FRAME_ROWS) {
+            return false;
+        }
+        for (const char* c = text; *c; c++) {
+            if (glyphIndex(*c) < 0) {
+                return false;
+            }
+        }
+
+        for (const char* c = text; *c; c++) {
+            const Glyph& glyph = glyphs[glyphIndex(*c)];
+            for (uint8_t r = 0; r < glyphRows; r++) {
+                uint8_t* target = frame + (row + r) * Width;
+                for (uint8_t column = 0; column < glyph.columns; column++) {
+                    int16_t px = x + column;
+                    if (px >= 0 && px < Width) {
+                        target[px] |= glyph.bits[r][column];
+                    }
+                }
+            }
+            x += glyph.advance;
+        }
+        return true;
+    }
+
+private:
+    struct Glyph {
+        uint8_t advance;
+        uint8_t columns;          // Columns holding pixels
+        uint8_t bits[GLYPH_MAX_ROWS][GLYPH_MAX_WIDTH];
+    };
+
+    uint8_t chrome[CHROME_PAGES][FRAME_BYTES];
+    bool chromeValid[CHROME_PAGES];
+    Glyph glyphs[GLYPH_COUNT];
+    bool glyphsValid;
+    int16_t glyphBaseline;
+    uint8_t glyphRow;             // First byte row the glyphs touch
+    uint8_t glyphRowEnd;
+    uint8_t glyphRows;
+};
+
+#endif // DASHBOARD_CACHE_H
@@ -0,0 +1,90 @@
+#include "dashboard_layouts.h"
+
+// SH1106 128x64, U8g2 fonts: 5x7, 6x10 and logisoso20
+const DashboardLayout SH1106_LAYOUT = {
+    // Speed & gear
+    { 64, 25, TEXT_CENTER },      // noData
+    { 64, 40, TEXT_CENTER },      // waiting
+    { 5, 25, TEXT_LEFT },         // speed
+    { 5, 35, TEXT_LEFT },         // speedUnit
+    { 90, 25, TEXT_LEFT },        // gear
+    { 90, 35, TEXT_LEFT },        // gearLabel
+    { 64, 35, TEXT_CENTER },      // speedStale
+    { 3, 51, 122, 8 },            // rpmBar
+    { 0, 48, 128, 14 },           // shiftCue: tile rows 6-7, like the bar
+    
+    // Lap & fuel
+    { 64, 32, TEXT_CENTER },      // lapNoData
+    { 0, 15, TEXT_LEFT },         // lapLabel
+    { 0, 30, TEXT_LEFT },         // lapTime
+    { SCREEN_WIDTH, 15, TEXT_RIGHT },  // position
+    { 0, 45, TEXT_LEFT },         // fuelLabel
+    { 0, 60, TEXT_LEFT },         // fuel
+    { SCREEN_WIDTH, 30, TEXT_RIGHT },  // lapSpeed
+    { SCREEN_WIDTH, 60, TEXT_RIGHT },  // lapRpm
+    { SCREEN_WIDTH, 45, TEXT_RIGHT },  // lapStale
+    
+    // Debug
+    { 0, 8, TEXT_LEFT },          // debugTitle
+    { SCREEN_WIDTH, 8, TEXT_RIGHT },  // counters
+    { 0, 18, TEXT_LEFT },         // valid
+    { SCREEN_WIDTH, 18, TEXT_RIGHT },  // sequence
+    { 0, 28, TEXT_LEFT },         // age
+    { SCREEN_WIDTH, 28, TEXT_RIGHT },  // flush
+    { SCREEN_WIDTH, 48, TEXT_RIGHT },  // drawTime
+    { 0, 38, TEXT_LEFT },         // packetType
+    { 0, 48, TEXT_LEFT },         // packetSize
+    { 0, 58, TEXT_LEFT },         // source
+    
+    // Settings
+    { 64, 15, TEXT_CENTER },      // settingsTitle
+    { 64, 35, TEXT_CENTER },      // game
+    { 64, 50, TEXT_CENTER },      // settingsHint
+    
+    { 64, 32, TEXT_CENTER },      // status
+};
+
+// SSD1306 128x32, GFX built-in font. Text size 1 lines have their baseline
+// at 7, 15, 23 and 31; size 2 at 14.
+const DashboardLayout SSD1306_LAYOUT = {
+    // Speed & gear
+    { 64, 15, TEXT_CENTER },      // noData
+    { 64, 25, TEXT_CENTER },      // waiting
+    { 0, 14, TEXT_LEFT },         // speed
+    { 0, 23, TEXT_LEFT },         // speedUnit
+    { 116, 14, TEXT_LEFT },       // gear
+    { 104, 23, TEXT_LEFT },       // gearLabel
+    { 64, 23, TEXT_CENTER },      // speedStale
+    { 1, 28, 126, 3 },            // rpmBar
+    { 0, 24, 128, 8 },            // shiftCue: a band above the bar
+    
+    // Lap & fuel
+    { 64, 19, TEXT_CENTER },      // lapNoData
+    { 0, 7, TEXT_LEFT },          // lapLabel
+    { 30, 7, TEXT_LEFT },         // lapTime
+    { 0, 27, TEXT_LEFT },         // position
+    { 0, 17, TEXT_LEFT },         // fuelLabel
+    { 36, 17, TEXT_LEFT },        // fuel
+    { 128, 7, TEXT_RIGHT },       // lapSpeed
+    { 128, 17, TEXT_RIGHT },      // lapRpm
+    { 128, 27, TEXT_RIGHT },      // lapStale
+    
+    // Debug: no room for the title, validity or flush line
+    { 0, 0, TEXT_HIDDEN },        // debugTitle
+    { 128, 15, TEXT_RIGHT },      // counters
+    { 0, 0, TEXT_HIDDEN },        // valid
+    { 128, 31, TEXT_RIGHT },      // sequence
+    { 0, 31, TEXT_LEFT },         // age
+    { 0, 0, TEXT_HIDDEN },        // flush
+    { 0, 0, TEXT_HIDDEN },        // drawTime
+    { 0, 7, TEXT_LEFT },          // packetType
+    { 0, 15, TEXT_LEFT },         // packetSize
+    { 0, 23, TEXT_LEFT },         // source
+    
+    // Settings
+    { 64, 7, TEXT_CENTER },       // settingsTitle
+    { 0, 19, TEXT_LEFT },         // game
+    { 0, 31, TEXT_LEFT },         // settingsHint
+    
+    { 64, 19, TEXT_CENTER },      // status
+};
@@ -0,0 +1,11 @@
+#ifndef DASHBOARD_LAYOUTS_H
+#define DASHBOARD_LAYOUTS_H
+
+#include "dashboard_renderer.h"
+
+// Where each panel puts the dashboard's elements. Plain data, kept apart from
+// the backends so host builds (test/host) can draw the same layouts.
+extern const DashboardLayout SH1106_LAYOUT;
+extern const DashboardLayout SSD1306_LAYOUT;
+
+#endif // DASHBOARD_LAYOUTS_H
@@ -0,0 +1,519 @@
+#ifndef DASHBOARD_RENDERER_H
+#define DASHBOARD_RENDERER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "telemetry_model.h"
+#include "dashboard_cache.h"
+
+// What the last completed frame put on the I2C bus
+struct DisplayFlushStats {
+    uint16_t tilesSent = 0;       // 8x8 tiles sent to the panel
+    uint16_t bytesSent = 0;       // Framebuffer bytes sent (8 per tile)
+    uint32_t flushMicros = 0;     // Time spent sending them, over all flush steps
+};
+
+// Text roles; each backend maps them to fonts it has
+enum DisplayFont {
+    FONT_SMALL,                   // Dense debug lines
+    FONT_NORMAL,                  // Labels, values, status messages
+    FONT_LARGE                    // Speed and gear
+};
+
+enum TextAlign : uint8_t {
+    TEXT_HIDDEN,                  // No room for it on this panel
+    TEXT_LEFT,
+    TEXT_RIGHT,
+    TEXT_CENTER
+};
+
+// Where one text element goes: x is its left edge, right edge or centre
+// depending on align, y its baseline
+struct TextSlot {
+    int16_t x;
+    int16_t y;
+    TextAlign align;
+};
+
+struct BoxSlot {
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+};
+
+// Where each panel puts every element the pages draw
+struct DashboardLayout {
+    // Speed & gear
+    TextSlot noData;
+    TextSlot waiting;
+    TextSlot speed;
+    TextSlot speedUnit;
+    TextSlot gear;                // Left edge; the gear is always one character
+    TextSlot gearLabel;
+    TextSlot speedStale;
+    BoxSlot rpmBar;
+    BoxSlot shiftCue;             // Lit round rpmBar, 1 pixel clear of it, while the cue is
+                                  // on. showRpmBar() redraws it, so nothing else may be in it.
+
+    // Lap & fuel
+    TextSlot lapNoData;
+    TextSlot lapLabel;
+    TextSlot lapTime;
+    TextSlot position;
+    TextSlot fuelLabel;
+    TextSlot fuel;
+    TextSlot lapSpeed;
+    TextSlot lapRpm;
+    TextSlot lapStale;
+
+    // Debug
+    TextSlot debugTitle;
+    TextSlot counters;
+    TextSlot valid;
+    TextSlot sequence;
+    TextSlot age;
+    TextSlot flush;
+    TextSlot drawTime;
+    TextSlot packetType;
+    TextSlot packetSize;
+    TextSlot source;
+
+    // Settings
+    TextSlot settingsTitle;
+    TextSlot game;
+    TextSlot settingsHint;
+
+    // showStatus() and anything unexpected
+    TextSlot status;
+};
+
+// The dashboard pages, written once for every panel. Backend derives from
+// DashboardRenderer<Backend> (CRTP) and provides the drawing primitives,
+// resolved at compile time so the render path has no virtual calls:
+//
+//   static const DashboardLayout layout;
+//   void clearFrame();
+//   void sendFrame();             // May finish later (see flushStep())
+//   void sendFrameNow();
+//   void setFont(DisplayFont font);
+//   void drawString(int16_t x, int16_t y, const char* text);  // y is the baseline
+//   int16_t stringWidth(const char* text);                    // In the current font
+//   void drawFrame(int16_t x, int16_t y, int16_t width, int16_t height);
+//   void drawBox(int16_t x, int16_t y, int16_t width, int16_t height);
+//   void clearBox(int16_t x, int16_t y, int16_t width, int16_t height);
+//   void sendRows(int16_t y, int16_t height);  // Now, at least these rows of the frame
+//   DisplayFlushStats getFlushStats() const;
+//
+// With DISPLAY_RENDER_CACHE it also provides, for the pre-rendered chrome and
+// glyphs (see dashboard_cache.h):
+//
+//   uint8_t* frameBuffer();
+//   DashboardCache<Width, Height> renderCache;
+template<typename Backend>
+class DashboardRenderer {
+public:
+    void showPage(int pageNumber, const TelemetryData& data, int gameType) {
+        Backend& out = backend();
+        unsigned long start = micros();
+        barShown = false;
+        bool chromeDrawn = restoreChrome(pageNumber, data);
+        if (!chromeDrawn) {
+            out.clearFrame();
+        }
+
+        switch (pageNumber) {
+            case PAGE_SPEED_GEAR:
+                showSpeedGearPage(data, chromeDrawn);
+                break;
+            case PAGE_LAP_FUEL:
+                showLapFuelPage(data, chromeDrawn);
+                break;
+            case PAGE_DEBUG:
+                showDebugPage(data);
+                break;
+            case PAGE_SETTINGS:
+                showSettingsPage(gameType, data.gameManual);
+                break;
+            default:
+                drawText(Backend::layout.status, FONT_NORMAL, "Invalid Page");
+                break;
+        }
+
+        renderMicros = micros() - start;
+        out.sendFrame();
+    }
+
+    // Hash of what showPage() would draw: the formatted speed, gear, RPM bar
+    // width and so on, not the raw values. Same key, same frame.
+    uint32_t pageKey(int pageNumber, const TelemetryData& data, int gameType) const {
+        uint32_t key = mixKey(2166136261u, pageNumber);
+        key = mixKey(key, (data.dataValid ? 1 : 0) | (data.stale ? 2 : 0));
+
+        switch (pageNumber) {
+            case PAGE_SPEED_GEAR:
+                key = mixKey(key, (int)data.speed);
+                key = mixKey(key, data.gear);
+                key = mixKey(key, rpmBarFill(data.rpm, data.maxRPM));
+                key = mixKey(key, data.shiftCue);
+                break;
+            case PAGE_LAP_FUEL:
+                key = mixKey(key, lroundf(data.lapTime * 1000.0f));
+                key = mixKey(key, data.position);
+                key = mixKey(key, lroundf(data.fuel * 10.0f));
+                key = mixKey(key, (int)data.speed);
+                key = mixKey(key, data.rpm);
+                break;
+            case PAGE_DEBUG:
+                // Nearly everything here moves; its refresh budget does the limiting
+                key = mixKey(key, data.lastUpdate);
+                key = mixKey(key, data.packetsDropped + data.framesCoalesced + data.sendersRejected +
+                                  data.framesLost + data.framesReordered + data.framesDuplicated);
+                key = mixKey(key, (millis() - data.lastUpdate) / 1000);
+                key = mixKey(key, backend().getFlushStats().bytesSent);
+                break;
+            case PAGE_SETTINGS:
+                key = mixKey(key, gameType);
+                key = mixKey(key, data.gameManual);
+                break;
+        }
+        return key;
+    }
+
+    // Fast path for the RPM bar: when a packet has moved the bar or the shift
+    // cue since it was drawn, redraws just the shiftCue area over the last
+    // frame and sends those rows straight away, not waiting for the page's
+    // refresh budget or the frame drain. Does nothing unless the last frame
+    // was the speed page with data. Returns true if it sent the bar.
+    bool showRpmBar(const TelemetryData& data) {
+        if (!barShown ||
+            (rpmBarFill(data.rpm, data.maxRPM) == drawnBarFill && data.shiftCue == drawnShiftCue)) {
+            return false;
+        }
+
+        Backend& out = backend();
+        const BoxSlot& area = Backend::layout.shiftCue;
+        out.clearBox(area.x, area.y, area.width, area.height);
+        drawRpmBar(data, false);
+        out.sendRows(area.y, area.height);
+        return true;
+    }
+
+    void showStatus(const char* message) {
+        Backend& out = backend();
+        barShown = false;
+        out.clearFrame();
+        drawText(Backend::layout.status, FONT_NORMAL, message);
+        out.sendFrameNow();
+    }
+
+    // Filled width of the RPM bar, inside its frame. maxRPM 0 (not reported
+    // yet) scales to RPM_BAR_DEFAULT_MAX.
+    static int rpmBarFill(int rpm, int maxRPM) {
+        int inner = Backend::layout.rpmBar.width - 2;
+        if (maxRPM <= 0) {
+            maxRPM = RPM_BAR_DEFAULT_MAX;
+        }
+        if (rpm <= 0) {
+            return 0;
+        }
+        return constrain((rpm * inner) / maxRPM, 0, inner);
+    }
+
+    // Time the last showPage() took to draw its frame, not counting the flush
+    uint32_t getRenderMicros() const {
+        return renderMicros;
+    }
+
+protected:
+    DashboardRenderer() : renderMicros(0), drawnBarFill(0), drawnShiftCue(false), barShown(false) {}
+
+    // Call from begin(), once the panel is up and before anything is drawn
+    void buildRenderCache() {
+#if DISPLAY_RENDER_CACHE
+        Backend& out = backend();
+        out.clearFrame();
+        drawSpeedGearChrome();
+        out.renderCache.saveChrome(PAGE_SPEED_GEAR, out.frameBuffer());
+        out.clearFrame();
+        drawLapFuelChrome();
+        out.renderCache.saveChrome(PAGE_LAP_FUEL, out.frameBuffer());
+
+        // One pass to find the rows the glyphs cover, one to copy them
+        int16_t baseline = Backend::layout.speed.y;
+        out.renderCache.beginGlyphs(baseline);
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            for (uint8_t i = 0; i < out.renderCache.GLYPH_COUNT; i++) {
+                char text[3] = { out.renderCache.glyphChar(i), 0, 0 };
+                out.clearFrame();
+                out.setFont(FONT_LARGE);
+                out.drawString(0, baseline, text);
+                if (pass == 0) {
+                    out.renderCache.measureGlyph(out.frameBuffer());
+                    continue;
+                }
+
+                // A lone glyph's width is its ink, not how far the font
+                // moves on; the "0" that follows it shows the advance
+                text[1] = '0';
+                int16_t advance = out.stringWidth(text) - out.stringWidth("0");
+                if (!out.renderCache.saveGlyph(i, out.frameBuffer(), advance)) {
+                    Serial.printf("Display: large '%c' blank or too big to cache\n", text[0]);
+                    out.clearFrame();
+                    return;
+                }
+            }
+        }
+        out.renderCache.endGlyphs();
+        out.clearFrame();
+#endif
+    }
+
+private:
+    Backend& backend() {
+        return static_cast<Backend&>(*this);
+    }
+
+    const Backend& backend() const {
+        return static_cast<const Backend&>(*this);
+    }
+
+    // Puts the page's static labels and frames in place of clearing the
+    // frame, if they are cached. Only for the live pages, not NO DATA.
+    bool restoreChrome(int pageNumber, const TelemetryData& data) {
+#if DISPLAY_RENDER_CACHE
+        if (data.dataValid || data.stale) {
+            return backend().renderCache.loadChrome(pageNumber, backend().frameBuffer());
+        }
+#else
+        (void)pageNumber;
+        (void)data;
+#endif
+        return false;
+    }
+
+    void drawSpeedGearChrome() {
+        const DashboardLayout& layout = Backend::layout;
+        const BoxSlot& bar = layout.rpmBar;
+        drawText(layout.speedUnit, FONT_NORMAL, "km/h");
+        drawText(layout.gearLabel, FONT_NORMAL, "GEAR");
+        backend().drawFrame(bar.x, bar.y, bar.width, bar.height);
+    }
+
+    void drawLapFuelChrome() {
+        const DashboardLayout& layout = Backend::layout;
+        drawText(layout.lapLabel, FONT_NORMAL, "LAP:");
+        drawText(layout.fuelLabel, FONT_NORMAL, "FUEL:");
+    }
+
+    void showSpeedGearPage(const TelemetryData& data, bool chromeDrawn) {
+        const DashboardLayout& layout = Backend::layout;
+
+        if (!data.dataValid && !data.stale) {
+            drawText(layout.noData, FONT_NORMAL, "NO DATA");
+            drawText(layout.waiting, FONT_NORMAL, "Waiting...");
+            return;
+        }
+
+        if (!chromeDrawn) {
+            drawSpeedGearChrome();
+        }
+
+        char text[12];
+        snprintf(text, sizeof(text), "%d", (int)data.speed);
+        drawLargeText(layout.speed, text);
+
+        if (data.gear == 0) {
+            snprintf(text, sizeof(text), "N");
+        } else if (data.gear == -1) {
+            snprintf(text, sizeof(text), "R");
+        } else {
+            snprintf(text, sizeof(text), "%d", data.gear);
+        }
+        drawLargeText(layout.gear, text);
+
+        // Last known values while WiFi recovers
+        if (data.stale) {
+            drawText(layout.speedStale, FONT_NORMAL, "STALE");
+        }
+
+        drawRpmBar(data, true);
+    }
+
+    // The bar, inside the shift cue while that's on. outlineDrawn: the bar's
+    // frame is already there (page chrome).
+    void drawRpmBar(const TelemetryData& data, bool outlineDrawn) {
+        const DashboardLayout& layout = Backend::layout;
+        const BoxSlot& bar = layout.rpmBar;
+        Backend& out = backend();
+
+        if (data.shiftCue) {
+            const BoxSlot& cue = layout.shiftCue;
+            out.drawBox(cue.x, cue.y, cue.width, cue.height);
+            out.clearBox(bar.x - 1, bar.y - 1, bar.width + 2, bar.height + 2);
+            outlineDrawn = false;
+        }
+        if (!outlineDrawn) {
+            out.drawFrame(bar.x, bar.y, bar.width, bar.height);
+        }
+
+        int fillWidth = rpmBarFill(data.rpm, data.maxRPM);
+        if (fillWidth > 0) {
+            out.drawBox(bar.x + 1, bar.y + 1, fillWidth, bar.height - 2);
+        }
+        drawnBarFill = fillWidth;
+        drawnShiftCue = data.shiftCue;
+        barShown = true;
+    }
+
+    void showLapFuelPage(const TelemetryData& data, bool chromeDrawn) {
+        const DashboardLayout& layout = Backend::layout;
+
+        if (!data.dataValid && !data.stale) {
+            drawText(layout.lapNoData, FONT_NORMAL, "NO DATA");
+            return;
+        }
+
+        if (!chromeDrawn) {
+            drawLapFuelChrome();
+        }
+
+        char text[16];
+        if (data.lapTime > 0) {
+            formatTime(text, sizeof(text), data.lapTime);
+        } else {
+            snprintf(text, sizeof(text), "--:--.---");
+        }
+        drawText(layout.lapTime, FONT_NORMAL, text);
+
+        if (data.position > 0) {
+            snprintf(text, sizeof(text), "P%d", data.position);
+            drawText(layout.position, FONT_NORMAL, text);
+        }
+
+        if (data.fuel > 0) {
+            snprintf(text, sizeof(text), "%.1f%%", data.fuel);
+        } else {
+            snprintf(text, sizeof(text), "--.-%%");
+        }
+        drawText(layout.fuel, FONT_NORMAL, text);
+
+        snprintf(text, sizeof(text), "%d km/h", (int)data.speed);
+        drawText(layout.lapSpeed, FONT_NORMAL, text);
+        snprintf(text, sizeof(text), "%d RPM", data.rpm);
+        drawText(layout.lapRpm, FONT_NORMAL, text);
+
+        // Last known values while WiFi recovers
+        if (data.stale) {
+            drawText(layout.lapStale, FONT_NORMAL, "STALE");
+        }
+    }
+
+    void showDebugPage(const TelemetryData& data) {
+        const DashboardLayout& layout = Backend::layout;
+        char text[32];
+
+        drawText(layout.debugTitle, FONT_SMALL, "DEBUG INFO");
+
+        // Receive ring overflows, packets replaced by a newer one of the same
+        // type, datagrams from senders other than the pinned one
+        snprintf(text, sizeof(text), "O%u C%u X%u", (unsigned)data.packetsDropped,
+                 (unsigned)data.framesCoalesced, (unsigned)data.sendersRejected);
+        drawText(layout.counters, FONT_SMALL, text);
+
+        snprintf(text, sizeof(text), "Valid: %s", data.dataValid ? "YES" : (data.stale ? "STALE" : "NO"));
+        drawText(layout.valid, FONT_SMALL, text);
+
+        // Frame sequencing: lost / reordered / duplicated
+        snprintf(text, sizeof(text), "L%u R%u D%u", (unsigned)data.framesLost,
+                 (unsigned)data.framesReordered, (unsigned)data.framesDuplicated);
+        drawText(layout.sequence, FONT_SMALL, text);
+
+        if (data.dataValid) {
+            snprintf(text, sizeof(text), "Age: %lus", (millis() - data.lastUpdate) / 1000);
+        } else {
+            snprintf(text, sizeof(text), "Age: -");
+        }
+        drawText(layout.age, FONT_SMALL, text);
+
+        // Last frame's display flush: bytes sent, time taken
+        DisplayFlushStats flushStats = backend().getFlushStats();
+        snprintf(text, sizeof(text), "Tx%uB %lums", (unsigned)flushStats.bytesSent,
+                 (unsigned long)(flushStats.flushMicros / 1000));
+        drawText(layout.flush, FONT_SMALL, text);
+
+        // Time the previous frame took to draw
+        snprintf(text, sizeof(text), "Draw %luus", (unsigned long)renderMicros);
+        drawText(layout.drawTime, FONT_SMALL, text);
+
+        snprintf(text, sizeof(text), "Type: %s", packetTypeName(data.lastPacketType));
+        drawText(layout.packetType, FONT_SMALL, text);
+        snprintf(text, sizeof(text), "Size: %db", data.lastPacketSize);
+        drawText(layout.packetSize, FONT_SMALL, text);
+        snprintf(text, sizeof(text), "From: %u.%u.%u.%u", (unsigned)(data.sourceIP & 0xFF),
+                 (unsigned)((data.sourceIP >> 8) & 0xFF), (unsigned)((data.sourceIP >> 16) & 0xFF),
+                 (unsigned)(data.sourceIP >> 24));
+        drawText(layout.source, FONT_SMALL, text);
+    }
+
+    void showSettingsPage(int gameType, bool gameManual) {
+        const DashboardLayout& layout = Backend::layout;
+
+        drawText(layout.settingsTitle, FONT_NORMAL, "SETTINGS");
+        char text[24];
+        snprintf(text, sizeof(text), "Game: %s (%s)", gameType == GAME_F1 ? "F1" : "PCARS",
+                 gameManual ? "manual" : "auto");
+        drawText(layout.game, FONT_NORMAL, text);
+        drawText(layout.settingsHint, FONT_NORMAL, gameManual ? "SELECT: auto game" : "SELECT: pin game");
+    }
+
+    // Large text from the glyph cache when it can, else from the font
+    void drawLargeText(const TextSlot& slot, const char* text) {
+#if DISPLAY_RENDER_CACHE
+        if (slot.align == TEXT_LEFT && backend().renderCache.blit(backend().frameBuffer(), slot.x, slot.y, text)) {
+            return;
+        }
+#endif
+        drawText(slot, FONT_LARGE, text);
+    }
+
+    void drawText(const TextSlot& slot, DisplayFont font, const char* text) {
+        if (slot.align == TEXT_HIDDEN) {
+            return;
+        }
+
+        Backend& out = backend();
+        out.setFont(font);
+        int16_t x = slot.x;
+        if (slot.align == TEXT_RIGHT) {
+            x -= out.stringWidth(text);
+        } else if (slot.align == TEXT_CENTER) {
+            x -= (out.stringWidth(text) + 1) / 2;
+        }
+        out.drawString(x, slot.y, text);
+    }
+
+    // MM:SS.mmm
+    static void formatTime(char* buffer, size_t size, float seconds) {
+        int minutes = (int)(seconds / 60);
+        float remainingSeconds = seconds - (minutes * 60);
+        snprintf(buffer, size, "%d:%06.3f", minutes, remainingSeconds);
+    }
+
+    // FNV-1a over the values a page shows
+    static uint32_t mixKey(uint32_t key, int32_t value) {
+        for (uint8_t i = 0; i < 4; i++) {
+            key = (key ^ ((value >> (i * 8)) & 0xFF)) * 16777619u;
+        }
+        return key;
+    }
+
+    uint32_t renderMicros;
+
+    // What showRpmBar() has to compare against
+    int drawnBarFill;
+    bool drawnShiftCue;
+    bool barShown;                // Last frame was the speed page with its bar
+};
+
+#endif // DASHBOARD_RENDERER_H
@@ -4,40 +4,50 @@
 #include <Adafruit_SSD1306.h>
 #include <Adafruit_GFX.h>
 #include "config.h"
+#include "dashboard_renderer.h"
+#include "dashboard_layouts.h"
 
-// Forward declaration for telemetry data
-struct TelemetryData;
-
-class DisplayManager {
+// SSD1306 128x32 backend of the dashboard pages
+class DisplayManager : public DashboardRenderer<DisplayManager> {
 public:
     DisplayManager();
     bool begin();
-    void showPage(int pageNumber, const TelemetryData& data, int gameType);
-    void showStatus(const String& message);
     void clear();
     void update();
+    // Frames go out whole, so there's never anything left to send
+    bool flushStep() { return false; }
+    DisplayFlushStats getFlushStats() const;
     
 private:
-    Adafruit_SSD1306 display;
-    
-    // Page rendering functions
-    void showSpeedGearPage(const TelemetryData& data);
-    void showLapFuelPage(const TelemetryData& data);
-    void showDebugPage(const TelemetryData& data);
-    void showSettingsPage(int gameType);
-    
-    // Helper functions
-    void drawRPMBar(int rpm, int maxRPM = 8000);
-    void drawCenteredText(const String& text, int y, int textSize = 1);
-    void drawRightAlignedText(const String& text, int x, int y, int textSize = 1);
-    String formatTime(float seconds);
-    String formatFloat(float value, int decimals = 1);
+    friend class DashboardRenderer<DisplayManager>;
     
     // Display constants
+    static const int PANEL_WIDTH = 128;
+    static const int PANEL_HEIGHT = 32;
     static const int CHAR_WIDTH = 6;
-    static const int CHAR_HEIGHT = 8;
-    static const int LARGE_CHAR_WIDTH = 12;
-    static const int LARGE_CHAR_HEIGHT = 16;
+    static const int CHAR_BASELINE = 7;   // Rows above the baseline at text size 1
+    
+    static const DashboardLayout& layout;
+    
+    Adafruit_SSD1306 display;
+#if DISPLAY_RENDER_CACHE
+    DashboardCache<PANEL_WIDTH, PANEL_HEIGHT> renderCache;
+#endif
+    uint8_t textSize;
+    DisplayFlushStats flushStats;
+    
+    // DashboardRenderer primitives
+    void clearFrame();
+    void sendFrame();
+    void sendFrameNow();
+    void setFont(DisplayFont font);
+    void drawString(int16_t x, int16_t y, const char* text);
+    int16_t stringWidth(const char* text);
+    void drawFrame(int16_t x, int16_t y, int16_t width, int16_t height);
+    void drawBox(int16_t x, int16_t y, int16_t width, int16_t height);
+    void clearBox(int16_t x, int16_t y, int16_t width, int16_t height);
+    void sendRows(int16_t y, int16_t height);
+    uint8_t* frameBuffer();
 };
 
-#endif // DISPLAY_MANAGER_H
\ No newline at end of file
+#endif // DISPLAY_MANAGER_H
@@ -1,21 +1,12 @@
 #include "display_manager_sh1106.h"
 
-// Include the telemetry data structure from main.cpp
-struct TelemetryData {
-    float speed;
-    int gear;
-    int rpm;
-    float fuel;
-    float lapTime;
-    int position;
-    bool dataValid;
-    unsigned long lastUpdate;
-    String lastPacketType;
-    int lastPacketSize;
-    String sourceIP;
-};
-
-DisplayManagerSH1106::DisplayManagerSH1106() : u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE) {
+const DashboardLayout& DisplayManagerSH1106::layout = SH1106_LAYOUT;
+
+DisplayManagerSH1106::DisplayManagerSH1106() :
+    u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE),
+    shadowValid(false),
+    flushCursor(0),
+    tilesToCheck(0) {
 }
 
 bool DisplayManagerSH1106::begin() {
@@ -42,202 +33,185 @@ bool DisplayManagerSH1106::begin() {
     
     Serial.println("SH1106 Display initialized successfully!");
     
+    buildRenderCache();
+    
     // Set font and show startup message
     u8g2.clearBuffer();
     u8g2.setFont(u8g2_font_6x10_tf);
     u8g2.drawStr(0, 10, "ESP8266 Telemetry");
     u8g2.drawStr(0, 25, "Dashboard");
     u8g2.drawStr(0, 40, "Starting...");
-    u8g2.sendBuffer();
+    flushAll();
     
     return true;
 }
 
-void DisplayManagerSH1106::showPage(int pageNumber, const TelemetryData& data, int gameType) {
-    Serial.printf("DisplayManagerSH1106::showPage - Page: %d, DataValid: %s\n", 
-                  pageNumber, data.dataValid ? "true" : "false");
-    
+void DisplayManagerSH1106::clear() {
     u8g2.clearBuffer();
-    
-    switch (pageNumber) {
-        case PAGE_SPEED_GEAR:
-            showSpeedGearPage(data);
-            break;
-        case PAGE_LAP_FUEL:
-            showLapFuelPage(data);
-            break;
-        case PAGE_DEBUG:
-            showDebugPage(data);
-            break;
-        case PAGE_SETTINGS:
-            showSettingsPage(gameType);
-            break;
-        default:
-            u8g2.setFont(u8g2_font_6x10_tf);
-            u8g2.drawStr(0, 20, "Invalid Page");
-            break;
+    flushAll();
+}
+
+void DisplayManagerSH1106::update() {
+    flushAll();
+}
+
+DisplayFlushStats DisplayManagerSH1106::getFlushStats() const {
+    return flushStats;
+}
+
+// Hands the finished back buffer to the drain
+void DisplayManagerSH1106::present() {
+    memcpy(front, u8g2.getBufferPtr(), sizeof(front));
+    tilesToCheck = u8g2.getBufferTileWidth() * u8g2.getBufferTileHeight();
+}
+
+// Sends the whole frame now, for status screens outside the loop
+void DisplayManagerSH1106::flushAll() {
+    present();
+    while (flushStep()) {
     }
-    
-    u8g2.sendBuffer();
 }
 
-void DisplayManagerSH1106::showSpeedGearPage(const TelemetryData& data) {
-    // Page 1: Big speed (left) + gear (right) + RPM bar (bottom)
-    
-    if (!data.dataValid) {
-        drawCenteredText("NO DATA", 25);
-        drawCenteredText("Waiting...", 40);
-        return;
+bool DisplayManagerSH1106::tileDiffers(uint16_t tile) const {
+    return !shadowValid || memcmp(front + tile * 8, shadow + tile * 8, 8) != 0;
+}
+
+// Sends a run of tiles in one tile row from front and records them in shadow
+void DisplayManagerSH1106::sendTiles(uint16_t tile, uint8_t count) {
+    uint8_t tileWidth = u8g2.getBufferTileWidth();
+    u8x8_DrawTile(u8g2.getU8x8(), tile % tileWidth, tile / tileWidth, count, front + tile * 8);
+    memcpy(shadow + tile * 8, front + tile * 8, count * 8);
+    drainStats.tilesSent += count;
+}
+
+// In U8g2's full buffer each tile row is one SH1106 page and a tile is 8
+// consecutive bytes, so tile n starts at byte n * 8 and u8x8_DrawTile() can
+// send a run of tiles in a row straight from front in one transfer.
+bool DisplayManagerSH1106::flushStep() {
+    if (tilesToCheck == 0) {
+        return false;
     }
     
-    // Speed on the left (large text)
-    u8g2.setFont(u8g2_font_logisoso20_tn);
-    char speedStr[8];
-    snprintf(speedStr, sizeof(speedStr), "%d", (int)data.speed);
-    u8g2.drawStr(5, 25, speedStr);
-    
-    // "km/h" label
-    u8g2.setFont(u8g2_font_6x10_tf);
-    u8g2.drawStr(5, 35, "km/h");
-    
-    // Gear on the right
-    u8g2.setFont(u8g2_font_logisoso20_tn);
-    char gearStr[4];
-    if (data.gear == 0) {
-        snprintf(gearStr, sizeof(gearStr), "N");
-    } else if (data.gear == -1) {
-        snprintf(gearStr, sizeof(gearStr), "R");
-    } else {
-        snprintf(gearStr, sizeof(gearStr), "%d", data.gear);
+    unsigned long start = micros();
+    uint8_t tileWidth = u8g2.getBufferTileWidth();
+    uint16_t tileCount = tileWidth * u8g2.getBufferTileHeight();
+    uint16_t budget = DISPLAY_FLUSH_TILES;
+    
+    while (tilesToCheck > 0 && budget > 0) {
+        uint16_t tile = flushCursor;
+        uint8_t tx = tile % tileWidth;
+        uint8_t count = 0;
+        while (tilesToCheck > 0 && count < budget && tx + count < tileWidth && tileDiffers(tile + count)) {
+            count++;
+            tilesToCheck--;
+        }
+        
+        if (count == 0) {
+            flushCursor = (tile + 1) % tileCount;
+            tilesToCheck--;
+            continue;
+        }
+        
+        sendTiles(tile, count);
+        budget -= count;
+        flushCursor = (tile + count) % tileCount;
     }
-    u8g2.drawStr(90, 25, gearStr);
+    drainStats.flushMicros += micros() - start;
     
-    // "GEAR" label
-    u8g2.setFont(u8g2_font_6x10_tf);
-    u8g2.drawStr(90, 35, "GEAR");
+    if (tilesToCheck > 0) {
+        return true;
+    }
     
-    // RPM bar at bottom
-    drawRPMBar(data.rpm);
+    shadowValid = true;
+    drainStats.bytesSent = drainStats.tilesSent * 8;
+    flushStats = drainStats;
+    drainStats = DisplayFlushStats();
+    return false;
 }
 
-void DisplayManagerSH1106::showLapFuelPage(const TelemetryData& data) {
-    if (!data.dataValid) {
-        drawCenteredText("NO DATA", 32);
-        return;
-    }
-    
-    u8g2.setFont(u8g2_font_6x10_tf);
-    
-    // Lap time
-    u8g2.drawStr(0, 15, "LAP TIME:");
-    String lapTimeStr = formatTime(data.lapTime);
-    u8g2.drawStr(0, 30, lapTimeStr.c_str());
-    
-    // Fuel
-    u8g2.drawStr(0, 45, "FUEL:");
-    String fuelStr = formatFloat(data.fuel, 1) + "%";
-    u8g2.drawStr(0, 60, fuelStr.c_str());
+void DisplayManagerSH1106::clearFrame() {
+    u8g2.clearBuffer();
 }
 
-void DisplayManagerSH1106::showDebugPage(const TelemetryData& data) {
-    u8g2.setFont(u8g2_font_5x7_tf);
-    
-    // Connection info
-    u8g2.drawStr(0, 8, "DEBUG INFO");
-    
-    String validStr = "Valid: " + String(data.dataValid ? "YES" : "NO");
-    u8g2.drawStr(0, 18, validStr.c_str());
-    
-    if (data.dataValid) {
-        String lastUpdateStr = "Age: " + String((millis() - data.lastUpdate) / 1000) + "s";
-        u8g2.drawStr(0, 28, lastUpdateStr.c_str());
-        
-        String packetStr = "Type: " + data.lastPacketType;
-        u8g2.drawStr(0, 38, packetStr.c_str());
-        
-        String sizeStr = "Size: " + String(data.lastPacketSize) + "b";
-        u8g2.drawStr(0, 48, sizeStr.c_str());
-        
-        String ipStr = "From: " + data.sourceIP;
-        u8g2.drawStr(0, 58, ipStr.c_str());
-    }
+void DisplayManagerSH1106::sendFrame() {
+    present();
+    flushStep();
 }
 
-void DisplayManagerSH1106::showSettingsPage(int gameType) {
-    u8g2.setFont(u8g2_font_6x10_tf);
-    
-    drawCenteredText("SETTINGS", 15);
-    
-    String gameStr = "Game: " + String(gameType == 0 ? "F1" : "PCARS");
-    drawCenteredText(gameStr, 35);
-    
-    drawCenteredText("Use buttons to", 50);
-    drawCenteredText("navigate", 60);
+void DisplayManagerSH1106::sendFrameNow() {
+    flushAll();
 }
 
-void DisplayManagerSH1106::drawRPMBar(int rpm, int maxRPM) {
-    // RPM bar at bottom of screen
-    int barY = 50;
-    int barHeight = 8;
-    int barWidth = 120;
-    int barX = 4;
+// Jumps the drain for the tile rows covering y to y + height - 1: copies them
+// from the back buffer to front and sends their changed tiles now, whatever
+// DISPLAY_FLUSH_TILES says. The drain finds them in shadow and skips them.
+// The tiles count in the flush stats of the frame being drained, or the next.
+void DisplayManagerSH1106::sendRows(int16_t y, int16_t height) {
+    if (height <= 0) {
+        return;
+    }
     
-    // Background
-    u8g2.drawFrame(barX, barY, barWidth, barHeight);
+    unsigned long start = micros();
+    uint8_t tileWidth = u8g2.getBufferTileWidth();
+    int16_t firstRow = constrain(y, 0, SCREEN_HEIGHT - 1) / 8;
+    int16_t lastRow = constrain(y + height - 1, 0, SCREEN_HEIGHT - 1) / 8;
     
-    // Fill based on RPM
-    if (rpm > 0 && maxRPM > 0) {
-        int fillWidth = (rpm * (barWidth - 2)) / maxRPM;
-        fillWidth = constrain(fillWidth, 0, barWidth - 2);
-        
-        if (fillWidth > 0) {
-            u8g2.drawBox(barX + 1, barY + 1, fillWidth, barHeight - 2);
+    uint16_t firstTile = firstRow * tileWidth;
+    uint16_t tileCount = (lastRow - firstRow + 1) * tileWidth;
+    memcpy(front + firstTile * 8, u8g2.getBufferPtr() + firstTile * 8, tileCount * 8);
+    
+    for (uint16_t tile = firstTile; tile < firstTile + tileCount; ) {
+        uint8_t count = 0;
+        while (tile % tileWidth + count < tileWidth && tileDiffers(tile + count)) {
+            count++;
+        }
+        if (count == 0) {
+            tile++;
+            continue;
         }
+        sendTiles(tile, count);
+        tile += count;
     }
+    drainStats.flushMicros += micros() - start;
 }
 
-void DisplayManagerSH1106::drawCenteredText(const String& text, int y) {
-    u8g2.setFont(u8g2_font_6x10_tf);
-    int textWidth = u8g2.getStrWidth(text.c_str());
-    int x = (SCREEN_WIDTH - textWidth) / 2;
-    u8g2.drawStr(x, y, text.c_str());
+void DisplayManagerSH1106::setFont(DisplayFont font) {
+    switch (font) {
+        case FONT_SMALL:
+            u8g2.setFont(u8g2_font_5x7_tf);
+            break;
+        case FONT_NORMAL:
+            u8g2.setFont(u8g2_font_6x10_tf);
+            break;
+        case FONT_LARGE:
+            // _tr, not the numbers-only _tn: the gear shows N and R too
+            u8g2.setFont(u8g2_font_logisoso20_tr);
+            break;
+    }
 }
 
-void DisplayManagerSH1106::drawRightAlignedText(const String& text, int x, int y) {
-    u8g2.setFont(u8g2_font_6x10_tf);
-    int textWidth = u8g2.getStrWidth(text.c_str());
-    u8g2.drawStr(x - textWidth, y, text.c_str());
+void DisplayManagerSH1106::drawString(int16_t x, int16_t y, const char* text) {
+    u8g2.drawStr(x, y, text);
 }
 
-String DisplayManagerSH1106::formatTime(float seconds) {
-    // Format time as MM:SS.mmm
-    int minutes = (int)(seconds / 60);
-    float remainingSeconds = seconds - (minutes * 60);
-    
-    char buffer[16];
-    snprintf(buffer, sizeof(buffer), "%d:%06.3f", minutes, remainingSeconds);
-    return String(buffer);
+int16_t DisplayManagerSH1106::stringWidth(const char* text) {
+    return u8g2.getStrWidth(text);
 }
 
-String DisplayManagerSH1106::formatFloat(float value, int decimals) {
-    char buffer[16];
-    char format[8];
-    snprintf(format, sizeof(format), "%%.%df", decimals);
-    snprintf(buffer, sizeof(buffer), format, value);
-    return String(buffer);
+void DisplayManagerSH1106::drawFrame(int16_t x, int16_t y, int16_t width, int16_t height) {
+    u8g2.drawFrame(x, y, width, height);
 }
 
-void DisplayManagerSH1106::showStatus(const String& message) {
-    u8g2.clearBuffer();
-    drawCenteredText(message, 32);
-    u8g2.sendBuffer();
+void DisplayManagerSH1106::drawBox(int16_t x, int16_t y, int16_t width, int16_t height) {
+    u8g2.drawBox(x, y, width, height);
 }
 
-void DisplayManagerSH1106::clear() {
-    u8g2.clearBuffer();
-    u8g2.sendBuffer();
+void DisplayManagerSH1106::clearBox(int16_t x, int16_t y, int16_t width, int16_t height) {
+    u8g2.setDrawColor(0);
+    u8g2.drawBox(x, y, width, height);
+    u8g2.setDrawColor(1);
 }
 
-void DisplayManagerSH1106::update() {
-    u8g2.sendBuffer();
-}
\ No newline at end of file
+uint8_t* DisplayManagerSH1106::frameBuffer() {
+    return u8g2.getBufferPtr();
+}
@@ -4,36 +4,62 @@
 #include <U8g2lib.h>
 #include <Wire.h>
 #include "config.h"
+#include "dashboard_renderer.h"
+#include "dashboard_layouts.h"
 
-// Forward declaration for telemetry data
-struct TelemetryData;
-
-class DisplayManagerSH1106 {
+// SH1106 128x64 backend of the dashboard pages
+class DisplayManagerSH1106 : public DashboardRenderer<DisplayManagerSH1106> {
 public:
     DisplayManagerSH1106();
     bool begin();
-    void showPage(int pageNumber, const TelemetryData& data, int gameType);
-    void showStatus(const String& message);
     void clear();
     void update();
+    // Sends up to DISPLAY_FLUSH_TILES changed tiles of the last frame; call
+    // every loop. Returns true while tiles are left to send.
+    bool flushStep();
+    DisplayFlushStats getFlushStats() const;
     
 private:
+    friend class DashboardRenderer<DisplayManagerSH1106>;
+    
+    static const DashboardLayout& layout;
+    
     U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2;
+#if DISPLAY_RENDER_CACHE
+    DashboardCache<SCREEN_WIDTH, SCREEN_HEIGHT> renderCache;
+#endif
     
-    // Page rendering functions
-    void showSpeedGearPage(const TelemetryData& data);
-    void showLapFuelPage(const TelemetryData& data);
-    void showDebugPage(const TelemetryData& data);
-    void showSettingsPage(int gameType);
+    // Pages draw into U8g2's buffer (the back buffer). A finished frame is
+    // copied to front and drained to the panel a few tiles per flushStep(),
+    // only the tiles that differ from shadow, the copy of what the panel
+    // shows. At 100 kHz the full 1 KB buffer takes ~90 ms to send, too long
+    // to hold up packet intake on ESP8266. A new frame simply replaces front;
+    // the drain carries on from where it was, so every tile gets its turn.
+    uint8_t front[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+    uint8_t shadow[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+    bool shadowValid;             // False until the first frame is fully sent
+    uint16_t flushCursor;         // Next tile to look at
+    uint16_t tilesToCheck;        // Tiles left to compare for the current frame
+    DisplayFlushStats drainStats; // Frame being drained
+    DisplayFlushStats flushStats;
     
-    // Helper functions
-    void drawRPMBar(int rpm, int maxRPM = 8000);
-    void drawCenteredText(const String& text, int y);
-    void drawRightAlignedText(const String& text, int x, int y);
-    String formatTime(float seconds);
-    String formatFloat(float value, int decimals = 1);
+    void present();
+    void flushAll();
+    bool tileDiffers(uint16_t tile) const;
+    void sendTiles(uint16_t tile, uint8_t count);
     
-    // Display constants (using config.h values)
+    // DashboardRenderer primitives
+    void clearFrame();
+    void sendFrame();
+    void sendFrameNow();
+    void setFont(DisplayFont font);
+    void drawString(int16_t x, int16_t y, const char* text);
+    int16_t stringWidth(const char* text);
+    void drawFrame(int16_t x, int16_t y, int16_t width, int16_t height);
+    void drawBox(int16_t x, int16_t y, int16_t width, int16_t height);
+    void clearBox(int16_t x, int16_t y, int16_t width, int16_t height);
+    void sendRows(int16_t y, int16_t height);
+    uint8_t* frameBuffer();
 };
 
 #endif // DISPLAY_MANAGER_SH1106_H
\ No newline at end of file
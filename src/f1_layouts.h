@@ -0,0 +1,275 @@
+#ifndef F1_LAYOUTS_H
+#define F1_LAYOUTS_H
+
+#include <stdint.h>
+#include "le_fields.h"
+
+// Per-year F1 UDP packet layouts (2019-2023).
+// Each specialization of F1Layout<Format> describes the packet sizes and the
+// fields worth decoding as LEField accessors; the handler table in
+// telemetry_f1.cpp decides which packets the dashboard actually decodes.
+// Decoders are instantiated once per format, so every field read uses a
+// compile-time offset and type and the only runtime decision is picking the
+// format from m_packetFormat.
+//
+// Per-car fields are relative to the start of one car's entry, body fields
+// are relative to the first byte after the header.
+
+template<uint16_t Format>
+struct F1Layout;
+
+// Fields that have not moved between 2019 and 2023
+struct F1LayoutCommon {
+    // Header (m_packetFormat is always the first field)
+    LE_FIELD(PacketFormat, uint16_t, 0);
+
+    // Session: m_weather, m_trackTemperature, m_airTemperature, m_totalLaps
+    LE_FIELD(SessionTotalLaps, uint8_t, 3);
+
+    // Participants: m_numActiveCars
+    LE_FIELD(ParticipantsNumActiveCars, uint8_t, 0);
+
+    // Motion (CarMotionData, 60 bytes)
+    LE_FIELD(MotionGForceLateral, float, 36);
+    LE_FIELD(MotionGForceLongitudinal, float, 40);
+
+    // Car telemetry
+    LE_FIELD(TelemetrySpeed, uint16_t, 0);       // km/h
+    LE_FIELD(TelemetryThrottle, float, 2);       // 0..1
+    LE_FIELD(TelemetryBrake, float, 10);         // 0..1
+    LE_FIELD(TelemetryGear, int8_t, 15);         // N = 0, R = -1
+    LE_FIELD(TelemetryEngineRPM, uint16_t, 16);
+    LE_FIELD(TelemetryDRS, uint8_t, 18);         // 0 = off, 1 = on
+    LE_FIELD(TelemetryRevLights, uint8_t, 19);   // m_revLightsPercent, 0-100
+
+    // Car status
+    LE_FIELD(StatusFuelInTank, float, 5);        // kg
+    LE_FIELD(StatusFuelCapacity, float, 9);      // kg
+    LE_FIELD(StatusMaxRPM, uint16_t, 17);
+
+    // Final classification: m_numCars, then one entry per car
+    LE_FIELD(FinalPosition, uint8_t, 0);
+    LE_FIELD(FinalNumLaps, uint8_t, 1);
+
+    enum : uint16_t {
+        kEventCode = 0,                  // Event: m_eventStringCode[4]
+        kEventPrefixSize = 4,
+        kSessionPrefixSize = SessionTotalLaps::kEnd,
+        kParticipantsPrefixSize = ParticipantsNumActiveCars::kEnd,
+        kMotionStride = 60,
+        kFinalPrefixSize = 1,
+
+        // Bytes after the car array (and any trailer) no decoder reads; a
+        // format that has some overrides these
+        kMotionUnreadSize = 0,
+        kLapDataUnreadSize = 0,
+        kTelemetryUnreadSize = 0,
+    };
+};
+
+// F1 2019: 23-byte header without m_secondaryPlayerCarIndex, 20 cars,
+// float lap times and no final classification packet
+template<>
+struct F1Layout<2019> : F1LayoutCommon {
+    LE_FIELD(PacketId, uint8_t, 5);
+    LE_FIELD(SessionUID, uint64_t, 6);
+    LE_FIELD(SequenceFrame, uint32_t, 18);       // m_frameIdentifier
+    LE_FIELD(PlayerCarIndex, uint8_t, 22);
+
+    LE_FIELD(LapLastLapTime, float, 0);          // seconds
+    LE_FIELD(LapCurrentLapTime, float, 4);
+    LE_FIELD(LapCarPosition, uint8_t, 32);
+    LE_FIELD(LapCurrentLapNum, uint8_t, 33);
+    LE_FIELD(SetupFuelLoad, float, 37);
+
+    enum : uint16_t {
+        kHeaderSize = 23,
+        kMaxCars = 20,
+
+        kMotionSize = 1343,
+        kSessionSize = 149,
+        kLapDataSize = 843,
+        kEventSize = 32,
+        kParticipantsSize = 1104,
+        kCarSetupsSize = 843,
+        kCarTelemetrySize = 1347,
+        kCarStatusSize = 1143,
+        kFinalClassificationSize = 0,    // Packet does not exist
+
+        kLapDataStride = 41,
+        kCarSetupsStride = 41,
+        kTelemetryStride = 66,
+        kTelemetryTrailerSize = 0,       // Trailer holds only m_buttonStatus
+        kCarStatusStride = 56,
+        kFinalStride = 0,
+
+        kMotionUnreadSize = 120,         // Player-only suspension and wheel data
+        kTelemetryUnreadSize = 4,        // m_buttonStatus
+    };
+};
+
+// F1 2020: 24-byte header, 22 cars, float lap times
+template<>
+struct F1Layout<2020> : F1LayoutCommon {
+    LE_FIELD(PacketId, uint8_t, 5);
+    LE_FIELD(SessionUID, uint64_t, 6);
+    LE_FIELD(SequenceFrame, uint32_t, 18);       // m_frameIdentifier
+    LE_FIELD(PlayerCarIndex, uint8_t, 22);
+
+    LE_FIELD(LapLastLapTime, float, 0);          // seconds
+    LE_FIELD(LapCurrentLapTime, float, 4);
+    LE_FIELD(LapCarPosition, uint8_t, 44);
+    LE_FIELD(LapCurrentLapNum, uint8_t, 45);
+    LE_FIELD(SetupFuelLoad, float, 45);
+    LE_FIELD(TelemetrySuggestedGear, int8_t, 6);  // In the trailer
+
+    enum : uint16_t {
+        kHeaderSize = 24,
+        kMaxCars = 22,
+
+        kMotionSize = 1464,
+        kSessionSize = 251,
+        kLapDataSize = 1190,
+        kEventSize = 35,
+        kParticipantsSize = 1213,
+        kCarSetupsSize = 1102,
+        kCarTelemetrySize = 1307,
+        kCarStatusSize = 1344,
+        kFinalClassificationSize = 839,
+
+        kLapDataStride = 53,
+        kCarSetupsStride = 49,
+        kTelemetryStride = 58,
+        kTelemetryTrailerSize = 7,       // m_buttonStatus, MFD indices, m_suggestedGear
+        kCarStatusStride = 60,
+        kFinalStride = 37,
+
+        kMotionUnreadSize = 120,         // Player-only suspension and wheel data
+    };
+};
+
+// F1 2021: lap times in milliseconds, m_buttonStatus moved to the event packet
+template<>
+struct F1Layout<2021> : F1LayoutCommon {
+    LE_FIELD(PacketId, uint8_t, 5);
+    LE_FIELD(SessionUID, uint64_t, 6);
+    LE_FIELD(SequenceFrame, uint32_t, 18);       // m_frameIdentifier
+    LE_FIELD(PlayerCarIndex, uint8_t, 22);
+
+    LE_FIELD(LapLastLapTime, uint32_t, 0);       // milliseconds
+    LE_FIELD(LapCurrentLapTime, uint32_t, 4);
+    LE_FIELD(LapCarPosition, uint8_t, 24);
+    LE_FIELD(LapCurrentLapNum, uint8_t, 25);
+    LE_FIELD(SetupFuelLoad, float, 45);
+    LE_FIELD(TelemetrySuggestedGear, int8_t, 2);  // In the trailer
+
+    enum : uint16_t {
+        kHeaderSize = 24,
+        kMaxCars = 22,
+
+        kMotionSize = 1464,
+        kSessionSize = 625,
+        kLapDataSize = 970,
+        kEventSize = 36,
+        kParticipantsSize = 1257,
+        kCarSetupsSize = 1102,
+        kCarTelemetrySize = 1347,
+        kCarStatusSize = 1058,
+        kFinalClassificationSize = 839,
+
+        kLapDataStride = 43,
+        kCarSetupsStride = 49,
+        kTelemetryStride = 60,
+        kTelemetryTrailerSize = 3,       // MFD indices, m_suggestedGear
+        kCarStatusStride = 47,
+        kFinalStride = 37,
+
+        kMotionUnreadSize = 120,         // Player-only suspension and wheel data
+    };
+};
+
+// F1 2022: as 2021 plus time trial indices after the lap data and tyre stint end laps
+template<>
+struct F1Layout<2022> : F1LayoutCommon {
+    LE_FIELD(PacketId, uint8_t, 5);
+    LE_FIELD(SessionUID, uint64_t, 6);
+    LE_FIELD(SequenceFrame, uint32_t, 18);       // m_frameIdentifier
+    LE_FIELD(PlayerCarIndex, uint8_t, 22);
+
+    LE_FIELD(LapLastLapTime, uint32_t, 0);       // milliseconds
+    LE_FIELD(LapCurrentLapTime, uint32_t, 4);
+    LE_FIELD(LapCarPosition, uint8_t, 24);
+    LE_FIELD(LapCurrentLapNum, uint8_t, 25);
+    LE_FIELD(SetupFuelLoad, float, 45);
+    LE_FIELD(TelemetrySuggestedGear, int8_t, 2);  // In the trailer
+
+    enum : uint16_t {
+        kHeaderSize = 24,
+        kMaxCars = 22,
+
+        kMotionSize = 1464,
+        kSessionSize = 632,
+        kLapDataSize = 972,
+        kEventSize = 40,
+        kParticipantsSize = 1257,
+        kCarSetupsSize = 1102,
+        kCarTelemetrySize = 1347,
+        kCarStatusSize = 1058,
+        kFinalClassificationSize = 1015,
+
+        kLapDataStride = 43,
+        kCarSetupsStride = 49,
+        kTelemetryStride = 60,
+        kTelemetryTrailerSize = 3,       // MFD indices, m_suggestedGear
+        kCarStatusStride = 47,
+        kFinalStride = 45,
+
+        kMotionUnreadSize = 120,         // Player-only suspension and wheel data
+        kLapDataUnreadSize = 2,          // Time trial PB and rival car indices
+    };
+};
+
+// F1 2023: 29-byte header (m_gameYear, m_overallFrameIdentifier), so the packet ID moves
+template<>
+struct F1Layout<2023> : F1LayoutCommon {
+    LE_FIELD(PacketId, uint8_t, 6);
+    LE_FIELD(SessionUID, uint64_t, 7);
+    LE_FIELD(SequenceFrame, uint32_t, 23);       // m_overallFrameIdentifier, doesn't rewind on flashbacks
+    LE_FIELD(PlayerCarIndex, uint8_t, 27);
+
+    LE_FIELD(LapLastLapTime, uint32_t, 0);       // milliseconds
+    LE_FIELD(LapCurrentLapTime, uint32_t, 4);
+    LE_FIELD(LapCarPosition, uint8_t, 30);
+    LE_FIELD(LapCurrentLapNum, uint8_t, 31);
+    LE_FIELD(SetupFuelLoad, float, 45);
+    LE_FIELD(TelemetrySuggestedGear, int8_t, 2);  // In the trailer
+
+    enum : uint16_t {
+        kHeaderSize = 29,
+        kMaxCars = 22,
+
+        kMotionSize = 1349,
+        kSessionSize = 644,
+        kLapDataSize = 1131,
+        kEventSize = 45,
+        kParticipantsSize = 1306,
+        kCarSetupsSize = 1107,
+        kCarTelemetrySize = 1352,
+        kCarStatusSize = 1239,
+        kFinalClassificationSize = 1020,
+
+        kLapDataStride = 50,
+        kCarSetupsStride = 49,
+        kTelemetryStride = 60,
+        kTelemetryTrailerSize = 3,       // MFD indices, m_suggestedGear
+        kCarStatusStride = 55,
+        kFinalStride = 45,
+
+        kLapDataUnreadSize = 2,          // Time trial PB and rival car indices
+    };
+};
+
+// Largest header of any supported format - enough to classify any packet
+#define F1_HEADER_PEEK_SIZE 29
+
+#endif // F1_LAYOUTS_H
@@ -0,0 +1,104 @@
+#include "f1_receiver.h"
+
+F1Receiver::F1Receiver(NetworkManager& network, F1TelemetryParser& parser) :
+    network(network),
+    parser(parser),
+    pendingSlots(0),
+    coalescedCount(0),
+    lastDatagramSize(0),
+    lastReceivedMicros(0) {
+    uint8_t next = 0;
+    #if F1_FIELD_TABLE
+    uint8_t nextTable = 0;
+    #endif
+    for (uint8_t i = 0; i < F1_PACKET_ID_COUNT; i++) {
+        #if F1_FIELD_TABLE
+        if (F1_TABLE_PACKETS & (1u << i)) {
+            slots[i] = tableStorage[nextTable++];
+            continue;
+        }
+        #endif
+        slots[i] = storage[next++];
+    }
+    spare = storage[next];
+    #if F1_FIELD_TABLE
+    tableSpare = tableStorage[nextTable];
+    #else
+    tableSpare = nullptr;
+    #endif
+}
+
+bool F1Receiver::receive() {
+    bool decoded = false;
+    UdpDatagram datagram;
+    for (uint8_t drained = 0; drained < UDP_DRAIN_LIMIT && network.readF1Packet(spare, tableSpare, datagram); drained++) {
+        lastDatagramSize = datagram.datagramSize;
+        lastSourceIP = datagram.remoteIP;
+        lastReceivedMicros = datagram.receivedMicros;
+        decoded |= admit(datagram);
+    }
+
+    decoded |= decodePending();
+    return decoded;
+}
+
+uint32_t F1Receiver::getCoalescedCount() const {
+    return coalescedCount;
+}
+
+int F1Receiver::getLastDatagramSize() const {
+    return lastDatagramSize;
+}
+
+IPAddress F1Receiver::getLastSourceIP() const {
+    return lastSourceIP;
+}
+
+uint32_t F1Receiver::getLastReceivedMicros() const {
+    return lastReceivedMicros;
+}
+
+// Sequences the packet just read into a spare and either decodes it (events)
+// or parks it in its type's slot. Returns true if it was decoded.
+bool F1Receiver::admit(const UdpDatagram& datagram) {
+    uint8_t packetId = datagram.tag;
+    uint8_t*& read = (F1_TABLE_PACKETS & (1u << packetId)) ? tableSpare : spare;
+    uint32_t sessionChanges = parser.getSequenceStats().sessionChanges;
+    if (!parser.admitCompactPacket(read, datagram.size)) {
+        return false;
+    }
+
+    // The parser reset its state for a new session - parked datagrams are from the old one
+    if (parser.getSequenceStats().sessionChanges != sessionChanges) {
+        pendingSlots = 0;
+    }
+
+    if (packetId == F1_PACKET_ID_EVENT) {
+        parser.decodeCompactPacket(read);
+        return true;
+    }
+
+    uint16_t bit = 1u << packetId;
+    if (pendingSlots & bit) {
+        coalescedCount++;
+    }
+    uint8_t* previous = slots[packetId];
+    slots[packetId] = read;
+    read = previous;
+    pendingSlots |= bit;
+    return false;
+}
+
+// Decodes the newest datagram of each type, in packet ID order
+bool F1Receiver::decodePending() {
+    if (pendingSlots == 0) {
+        return false;
+    }
+    for (uint8_t i = 0; i < F1_PACKET_ID_COUNT; i++) {
+        if (pendingSlots & (1u << i)) {
+            parser.decodeCompactPacket(slots[i]);
+        }
+    }
+    pendingSlots = 0;
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef F1_RECEIVER_H
+#define F1_RECEIVER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "network_manager.h"
+#include "telemetry_f1.h"
+
+// Drains the F1 receive ring and keeps only the newest datagram of each packet
+// type. The game sends several packet types per frame at up to 60 Hz, so by
+// the time the loop comes back round there are often a few of each queued;
+// decoding all of them only to show the last one costs a render slot.
+//
+// Every datagram still goes through the parser's frame sequencing as it
+// arrives, so stale and duplicate frames never replace a newer one and the
+// lost/reordered counters stay accurate. Event packets are one-offs and are
+// decoded straight away instead of being coalesced.
+class F1Receiver {
+public:
+    F1Receiver(NetworkManager& network, F1TelemetryParser& parser);
+
+    // Reads up to UDP_DRAIN_LIMIT queued packets, then decodes each surviving
+    // packet type once. Returns true if anything was decoded.
+    bool receive();
+
+    // Datagrams replaced by a newer one of the same type before being decoded
+    uint32_t getCoalescedCount() const;
+    int getLastDatagramSize() const;
+    IPAddress getLastSourceIP() const;
+    // micros() when the newest datagram read arrived
+    uint32_t getLastReceivedMicros() const;
+
+private:
+    NetworkManager& network;
+    F1TelemetryParser& parser;
+
+    // One buffer per packet type plus a spare the next datagram is read into;
+    // an admitted datagram swaps its buffer with its type's slot. The
+    // F1_TABLE_PACKETS swap among full-size buffers of their own.
+    uint8_t storage[F1_PACKET_ID_COUNT - F1_TABLE_PACKET_COUNT + 1][F1_COMPACT_PACKET_SIZE];
+    #if F1_FIELD_TABLE
+    uint8_t tableStorage[F1_TABLE_PACKET_COUNT + 1][F1_TABLE_PACKET_SIZE];
+    #endif
+    uint8_t* slots[F1_PACKET_ID_COUNT];
+    uint8_t* spare;
+    uint8_t* tableSpare;          // nullptr without F1_FIELD_TABLE
+    uint16_t pendingSlots;        // Bitmask of (1 << packetId) holding an undecoded datagram
+
+    uint32_t coalescedCount;
+    int lastDatagramSize;
+    IPAddress lastSourceIP;
+    uint32_t lastReceivedMicros;
+
+    bool admit(const UdpDatagram& datagram);
+    bool decodePending();
+};
+
+#endif // F1_RECEIVER_H
@@ -0,0 +1,133 @@
+#include "game_selector.h"
+
+#define UDP_SRC(source) (1u << (source))
+
+const uint8_t GameSelector::gameSources[GAME_COUNT] = {
+    // GAME_F1
+    UDP_SRC(UDP_SOURCE_F1),
+    // GAME_PCARS
+    UDP_SRC(UDP_SOURCE_PCARS) | UDP_SRC(UDP_SOURCE_PCARS_FORWARDER),
+};
+
+const char* const GameSelector::gameNames[GAME_COUNT] = { "F1", "PCARS" };
+
+GameSelector::GameSelector(NetworkManager& network) :
+    network(network),
+    game(GAME_F1),
+    manualGame(GAME_AUTO),
+    requestedGame(GAME_AUTO),
+    windowStart(0),
+    challenger(-1),
+    leadWindows(0) {
+    for (int i = 0; i < GAME_COUNT; i++) {
+        lastCounts[i] = 0;
+    }
+}
+
+void GameSelector::begin(int initialGame) {
+    game = initialGame;
+    network.setActiveSources(gameSources[game]);
+    restartSampling(millis());
+}
+
+bool GameSelector::update(unsigned long currentTime) {
+    int requested = requestedGame.load();
+    if (requested != manualGame) {
+        manualGame = requested;
+        if (manualGame == GAME_AUTO) {
+            // Counts from while the game was pinned say nothing about now
+            restartSampling(currentTime);
+            Serial.println("Game selection: auto");
+            return false;
+        }
+        if (manualGame == game) {
+            Serial.printf("Manual game: %s\n", gameNames[game]);
+            return false;
+        }
+        select(manualGame);
+        return true;
+    }
+    if (manualGame != GAME_AUTO || currentTime - windowStart < GAME_RATE_WINDOW_MS) {
+        return false;
+    }
+    windowStart = currentTime;
+    
+    uint32_t counts[GAME_COUNT];
+    for (int i = 0; i < GAME_COUNT; i++) {
+        uint32_t total = validPackets(i);
+        counts[i] = total - lastCounts[i];
+        lastCounts[i] = total;
+    }
+    
+    // The busiest game that clearly beats the selected one this window
+    int leader = -1;
+    for (int i = 0; i < GAME_COUNT; i++) {
+        if (i != game && counts[i] >= GAME_SWITCH_MIN_PACKETS &&
+            counts[i] > counts[game] * GAME_SWITCH_RATIO &&
+            (leader < 0 || counts[i] > counts[leader])) {
+            leader = i;
+        }
+    }
+    
+    if (leader != challenger) {
+        challenger = leader;
+        leadWindows = 0;
+    }
+    if (challenger < 0 || ++leadWindows < GAME_SWITCH_WINDOWS) {
+        return false;
+    }
+    
+    select(challenger);
+    return true;
+}
+
+int GameSelector::getGame() const {
+    return game;
+}
+
+bool GameSelector::isManual() const {
+    return manualGame != GAME_AUTO;
+}
+
+void GameSelector::requestGame(int requested) {
+    requestedGame.store(requested);
+}
+
+int GameSelector::getRequestedGame() const {
+    return requestedGame.load();
+}
+
+void GameSelector::restartSampling(unsigned long currentTime) {
+    for (int i = 0; i < GAME_COUNT; i++) {
+        lastCounts[i] = validPackets(i);
+    }
+    windowStart = currentTime;
+    challenger = -1;
+    leadWindows = 0;
+}
+
+uint32_t GameSelector::validPackets(int forGame) const {
+    uint32_t total = 0;
+    for (uint8_t source = 0; source < UDP_SOURCE_COUNT; source++) {
+        if (gameSources[forGame] & UDP_SRC(source)) {
+            total += network.getValidPacketCount(source);
+        }
+    }
+    return total;
+}
+
+void GameSelector::select(int newGame) {
+    game = newGame;
+    challenger = -1;
+    leadWindows = 0;
+    
+    network.setActiveSources(gameSources[game]);
+    // Anything still queued is from before the switch
+    network.discardQueued();
+    
+    if (manualGame == GAME_AUTO) {
+        Serial.printf("Auto-selected game: %s\n", gameNames[game]);
+    } else {
+        Serial.printf("Manual game: %s\n", gameNames[game]);
+    }
+}
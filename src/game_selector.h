@@ -0,0 +1,56 @@
+#ifndef GAME_SELECTOR_H
+#define GAME_SELECTOR_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "network_manager.h"
+
+// Chooses the game to decode from the valid-packet rate on each game's
+// listeners, so switching titles needs no button presses. NetworkManager
+// header-checks and counts every datagram; only the selected game's are
+// queued. A challenger has to beat the selected game clearly, for several
+// windows in a row (see GAME_SWITCH_* in config.h), so a few stray packets
+// or two senders at once don't make it flip back and forth.
+//
+// A game can also be pinned by hand, for when the traffic picks the wrong
+// one; automatic selection is suspended until it is released.
+//
+// Runs on the receive side: selecting a game empties the receive rings.
+// Only requestGame() and getRequestedGame() may be called from the
+// interface side.
+class GameSelector {
+public:
+    explicit GameSelector(NetworkManager& network);
+    void begin(int initialGame);
+    // Applies a pending requestGame(), then samples the counters once per
+    // GAME_RATE_WINDOW_MS unless a game is pinned. Returns true if another
+    // game was selected.
+    bool update(unsigned long currentTime);
+    int getGame() const;
+    bool isManual() const;
+
+    // Pins a game, or GAME_AUTO to go back to automatic selection; takes
+    // effect on the next update()
+    void requestGame(int requested);
+    int getRequestedGame() const;
+
+private:
+    static const uint8_t gameSources[GAME_COUNT];  // UDP_SOURCE_* mask per game
+    static const char* const gameNames[GAME_COUNT];
+
+    NetworkManager& network;
+    int game;
+    int manualGame;                    // Pinned game, GAME_AUTO if none
+    std::atomic<int> requestedGame;    // Set from the interface side
+    uint32_t lastCounts[GAME_COUNT];   // Valid packets per game at the last sample
+    unsigned long windowStart;
+    int challenger;                    // Game leading the selected one, -1 if none
+    uint8_t leadWindows;               // Windows in a row it has led
+
+    uint32_t validPackets(int forGame) const;
+    void restartSampling(unsigned long currentTime);
+    void select(int newGame);
+};
+
+#endif // GAME_SELECTOR_H
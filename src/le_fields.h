@@ -0,0 +1,81 @@
+#ifndef LE_FIELDS_H
+#define LE_FIELDS_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Little-endian field accessors for raw UDP buffers.
+// Loads are assembled from single bytes, so they never trap or fall back to
+// emulated unaligned loads on Xtensa, and they give the same result on any
+// host byte order. Offsets are template arguments, so every access compiles
+// down to a fixed displacement from the base pointer.
+
+template<typename T>
+inline T loadLE(const uint8_t* p);
+
+template<>
+inline uint8_t loadLE<uint8_t>(const uint8_t* p) {
+    return p[0];
+}
+
+template<>
+inline int8_t loadLE<int8_t>(const uint8_t* p) {
+    return static_cast<int8_t>(p[0]);
+}
+
+template<>
+inline uint16_t loadLE<uint16_t>(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+template<>
+inline int16_t loadLE<int16_t>(const uint8_t* p) {
+    return static_cast<int16_t>(loadLE<uint16_t>(p));
+}
+
+template<>
+inline uint32_t loadLE<uint32_t>(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+template<>
+inline uint64_t loadLE<uint64_t>(const uint8_t* p) {
+    return static_cast<uint64_t>(loadLE<uint32_t>(p)) |
+           (static_cast<uint64_t>(loadLE<uint32_t>(p + 4)) << 32);
+}
+
+template<>
+inline float loadLE<float>(const uint8_t* p) {
+    uint32_t bits = loadLE<uint32_t>(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// A typed field at a compile-time offset
+template<typename T, uint16_t Offset>
+struct LEField {
+    typedef T Type;
+    enum : uint16_t {
+        kOffset = Offset,
+        kEnd = Offset + sizeof(T)   // One past the last byte, for bounds checks
+    };
+    static inline T get(const uint8_t* base) {
+        return loadLE<T>(base + Offset);
+    }
+};
+
+// True if the field lies entirely inside the first size bytes of a record
+template<typename Field>
+constexpr bool fieldFits(unsigned size) {
+    return static_cast<unsigned>(Field::kEnd) <= size;
+}
+
+// Declares a field accessor inside a layout struct:
+//   LE_FIELD(EngineRPM, uint16_t, 16);  ->  Layout::EngineRPM::get(car)
+#define LE_FIELD(name, type, offset) typedef LEField<type, offset> name
+
+#endif // LE_FIELDS_H
@@ -4,14 +4,22 @@
 #else
     #include <WiFi.h>
 #endif
-#include <WiFiUdp.h>
 #include <Wire.h>
+#include <atomic>
 #include "config.h"
 #include "network_manager.h"
+#include "f1_receiver.h"
+#include "game_selector.h"
+#include "shift_light.h"
+#include "telemetry_receiver.h"
+#include "telemetry_model.h"
 #include "display_manager_sh1106.h"
 #include "buttons.h"
 #include "telemetry_f1.h"
 #include "telemetry_pcars.h"
+#ifndef ESP8266_BOARD
+    #include "snapshot_buffer.h"
+#endif
 
 // Global objects
 NetworkManager networkManager;
@@ -19,27 +27,54 @@ DisplayManagerSH1106 displayManager;
 ButtonManager buttonManager;
 F1TelemetryParser f1Parser;
 PCARSTelemetryParser pcarsParser;
+F1Receiver f1Receiver(networkManager, f1Parser);
+GameSelector gameSelector(networkManager);
+ShiftLight shiftLight;
+TelemetryReceiver telemetryReceiver(networkManager, f1Receiver, f1Parser, pcarsParser, shiftLight);
 
-// Global state
+// Global state. On ESP32 the telemetry task selects the game while the
+// render task reads it, hence the atomic.
 int currentPage = PAGE_SPEED_GEAR;
-int currentGame = GAME_F1;
-unsigned long lastTelemetryUpdate = 0;
-unsigned long lastWiFiCheck = 0;
+std::atomic<int> currentGame(GAME_F1);
+unsigned long lastRenderTime = 0;
+uint32_t lastPageKey = 0;           // displayManager.pageKey() of the last frame drawn
+
+#ifndef ESP8266_BOARD
+void telemetryTask(void* parameter);
+void renderTask(void* parameter);
+#endif
+
+// F1 packets each page needs; everything else is dropped on the header peek.
+// Car telemetry keeps the data fresh on every page, events catch session restarts.
+#define F1_PKT(id) (1u << (id))
+const uint16_t f1PagePackets[MAX_PAGES] = {
+    // PAGE_SPEED_GEAR
+    F1_PKT(F1_PACKET_ID_CAR_TELEMETRY) | F1_PKT(F1_PACKET_ID_CAR_STATUS) | F1_PKT(F1_PACKET_ID_EVENT),
+    // PAGE_LAP_FUEL
+    F1_PKT(F1_PACKET_ID_CAR_TELEMETRY) | F1_PKT(F1_PACKET_ID_CAR_STATUS) | F1_PKT(F1_PACKET_ID_EVENT) |
+    F1_PKT(F1_PACKET_ID_LAP_DATA),
+    // PAGE_DEBUG
+    0xFFFF,
+    // PAGE_SETTINGS
+    F1_PKT(F1_PACKET_ID_CAR_TELEMETRY) | F1_PKT(F1_PACKET_ID_EVENT),
+};
+
+// Render governor: a page is redrawn when something it shows changes (see
+// DashboardRenderer::pageKey), no more often than minIntervalMs and at
+// least every maxIntervalMs
+struct PageRefresh {
+    uint16_t minIntervalMs;
+    uint16_t maxIntervalMs;
+};
+const PageRefresh pageRefresh[MAX_PAGES] = {
+    { 33, 1000 },     // PAGE_SPEED_GEAR: up to 30 Hz
+    { 100, 1000 },    // PAGE_LAP_FUEL: 10 Hz
+    { 500, 500 },     // PAGE_DEBUG: 2 Hz, counters and age move all the time
+    { 200, 2000 },    // PAGE_SETTINGS
+};
 
 // Telemetry data structure
-struct TelemetryData {
-    float speed = 0.0f;
-    int gear = 0;
-    int rpm = 0;
-    float fuel = 0.0f;
-    float lapTime = 0.0f;
-    int position = 0;
-    bool dataValid = false;
-    unsigned long lastUpdate = 0;
-    String lastPacketType = "None";
-    int lastPacketSize = 0;
-    String sourceIP = "0.0.0.0";
-} telemetryData;
+TelemetryData telemetryData;
 
 void setup() {
     Serial.begin(115200);
@@ -70,21 +105,15 @@ void setup() {
     // Initialize buttons
     buttonManager.begin();
     
-    // Initialize network
-    displayManager.showStatus("Connecting WiFi...");
-    if (!networkManager.begin()) {
-        Serial.println("Network initialization failed!");
-        displayManager.showStatus("WiFi Failed!");
-        delay(2000);
-    } else {
-        String ip = WiFi.localIP().toString();
-        Serial.println("Connected! IP: " + ip);
-        displayManager.showStatus("IP: " + ip);
-        delay(2000);
-    }
+    // Initialize network - the receive callback plans F1 reads with the parser
+    networkManager.attachF1Parser(f1Parser);
+    gameSelector.begin(currentGame);
+    // Connects in the background; update() in the interface pass drives it
+    networkManager.begin();
     
     // Initialize telemetry parsers
     f1Parser.begin();
+    f1Parser.setWantedPackets(f1PagePackets[currentPage]);
     pcarsParser.begin();
     
     Serial.println("Setup complete!");
@@ -95,134 +124,116 @@ void setup() {
     delay(2000);
     
     displayManager.showPage(currentPage, telemetryData, currentGame);
-    Serial.printf("Showing page %d for game %d\n", currentPage, currentGame);
+    Serial.printf("Showing page %d for game %d\n", currentPage, currentGame.load());
+    
+    #ifndef ESP8266_BOARD
+    // Receive and parse next to the WiFi stack, render on the other core, so a
+    // slow display flush never holds up packet intake
+    xTaskCreatePinnedToCore(telemetryTask, "telemetry", TELEMETRY_TASK_STACK_SIZE, nullptr,
+                            TELEMETRY_TASK_PRIORITY, nullptr, TELEMETRY_TASK_CORE);
+    xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK_SIZE, nullptr,
+                            RENDER_TASK_PRIORITY, nullptr, RENDER_TASK_CORE);
+    #endif
 }
 
-void loop() {
-    unsigned long currentTime = millis();
-    
-    // Check WiFi connection periodically
-    if (currentTime - lastWiFiCheck > WIFI_RECONNECT_INTERVAL_MS) {
-        if (!networkManager.isConnected()) {
-            Serial.println("WiFi disconnected, attempting reconnect...");
-            displayManager.showStatus("Reconnecting...");
-            networkManager.reconnect();
-        }
-        lastWiFiCheck = currentTime;
+// Receive side: follows the game that is sending and drains its receive
+// queue into telemetryData. Returns true if new telemetry was decoded.
+bool receiveTelemetry(unsigned long currentTime) {
+    if (gameSelector.update(currentTime)) {
+        currentGame = gameSelector.getGame();
     }
-    
-    #ifdef ESP8266_BOARD
-    // ESP8266 needs yield() to prevent watchdog reset
-    yield();
-    #endif
+    telemetryData.gameManual = gameSelector.isManual();
+    return telemetryReceiver.receive(currentGame, telemetryData, currentTime);
+}
+
+// Interface side: WiFi state machine, buttons and the display, from a
+// telemetry snapshot
+void updateInterface(const TelemetryData& data, unsigned long currentTime) {
+    // Connect/reconnect without blocking, so the pages keep updating
+    networkManager.update(currentTime);
     
     // Handle button presses
+    bool pageChanged = false;
     ButtonEvent event = buttonManager.update();
     if (event == BUTTON_NEXT_PRESSED) {
         currentPage = (currentPage + 1) % MAX_PAGES;
-        displayManager.showPage(currentPage, telemetryData, currentGame);
-    } else if (event == BUTTON_SELECT_PRESSED) {
-        if (currentPage == PAGE_SETTINGS) {
-            currentGame = (currentGame == GAME_F1) ? GAME_PCARS : GAME_F1;
-            Serial.println("Switched to game: " + String(currentGame == GAME_F1 ? "F1" : "PCARS"));
-            displayManager.showPage(currentPage, telemetryData, currentGame);
+        f1Parser.setWantedPackets(f1PagePackets[currentPage]);
+        pageChanged = true;
+    } else if (event == BUTTON_SELECT_PRESSED && currentPage == PAGE_SETTINGS) {
+        // Pin the other game; the next press hands the choice back to the
+        // selector. The receive side applies it on its next pass.
+        if (gameSelector.getRequestedGame() == GAME_AUTO) {
+            gameSelector.requestGame(currentGame == GAME_F1 ? GAME_PCARS : GAME_F1);
+        } else {
+            gameSelector.requestGame(GAME_AUTO);
         }
     }
     
-    // Process telemetry data
-    bool dataUpdated = false;
-    
-    if (currentGame == GAME_F1) {
-        // Process F1 telemetry
-        if (networkManager.hasF1Data()) {
-            uint8_t buffer[UDP_BUFFER_SIZE];
-            int packetSize;
-            IPAddress sourceIP;
-            
-            if (networkManager.readF1Data(buffer, packetSize, sourceIP)) {
-                telemetryData.lastPacketSize = packetSize;
-                telemetryData.sourceIP = sourceIP.toString();
-                
-                if (f1Parser.parsePacket(buffer, packetSize)) {
-                    F1TelemetryData f1Data = f1Parser.getLatestData();
-                    
-                    telemetryData.speed = f1Data.speed;
-                    telemetryData.gear = f1Data.gear;
-                    telemetryData.rpm = f1Data.engineRPM;
-                    telemetryData.fuel = f1Data.fuelInTank;
-                    telemetryData.lapTime = f1Data.lastLapTime;
-                    telemetryData.dataValid = true;
-                    telemetryData.lastUpdate = currentTime;
-                    telemetryData.lastPacketType = "F1 CarTelemetry";
-                    
-                    dataUpdated = true;
-                    
-                    #if DEBUG_UDP
-                    Serial.printf("F1 Data: Speed=%.1f, Gear=%d, RPM=%d\n", 
-                                 telemetryData.speed, telemetryData.gear, telemetryData.rpm);
-                    #endif
-                } else {
-                    #if DEBUG_UDP
-                    Serial.printf("F1 Parse FAILED: %d bytes from %s\n", packetSize, sourceIP.toString().c_str());
-                    #endif
-                }
-            } else {
-                #if DEBUG_UDP
-                Serial.println("F1 Read FAILED");
-                #endif
-            }
-        }
-    } else {
-        // Process PCARS telemetry
-        if (networkManager.hasPCARSData()) {
-            uint8_t buffer[UDP_BUFFER_SIZE];
-            int packetSize;
-            IPAddress sourceIP;
-            
-            if (networkManager.readPCARSData(buffer, packetSize, sourceIP)) {
-                telemetryData.lastPacketSize = packetSize;
-                telemetryData.sourceIP = sourceIP.toString();
-                
-                if (pcarsParser.parsePacket(buffer, packetSize)) {
-                    PCARSTelemetryData pcarsData = pcarsParser.getLatestData();
-                    
-                    telemetryData.speed = pcarsData.speed;
-                    telemetryData.gear = pcarsData.gear;
-                    telemetryData.rpm = pcarsData.rpm;
-                    telemetryData.fuel = pcarsData.fuel;
-                    telemetryData.lapTime = pcarsData.lapTime;
-                    telemetryData.dataValid = true;
-                    telemetryData.lastUpdate = currentTime;
-                    telemetryData.lastPacketType = pcarsData.isForwarderData ? "PCARS JSON" : "PCARS UDP";
-                    
-                    dataUpdated = true;
-                    
-                    #if DEBUG_UDP
-                    Serial.printf("PCARS Data: Speed=%.1f, Gear=%d, RPM=%d\n", 
-                                 telemetryData.speed, telemetryData.gear, telemetryData.rpm);
-                    #endif
-                }
-            }
-        }
+    // A packet that moved the RPM bar gets it onto the panel now, outside the
+    // refresh budget; how long that took from the datagram arriving is how
+    // far ahead the shift cue looks
+    if (!pageChanged && displayManager.showRpmBar(data) && data.receivedMicros != 0) {
+        shiftLight.addLatencySample(micros() - data.receivedMicros);
     }
     
-    // Check for data timeout (2 seconds for more stability)
-    if (currentTime - telemetryData.lastUpdate > 2000) {
-        telemetryData.dataValid = false;
+    // Redraw only when the page would look different, within its refresh budget
+    const PageRefresh& refresh = pageRefresh[currentPage];
+    unsigned long sinceRender = currentTime - lastRenderTime;
+    if (pageChanged || sinceRender >= refresh.minIntervalMs) {
+        uint32_t key = displayManager.pageKey(currentPage, data, currentGame);
+        if (pageChanged || key != lastPageKey || sinceRender >= refresh.maxIntervalMs) {
+            displayManager.showPage(currentPage, data, currentGame);
+            lastPageKey = key;
+            lastRenderTime = currentTime;
+        }
     }
     
-    // Update display if data changed or periodically
-    if (dataUpdated || (currentTime - lastTelemetryUpdate > 100)) {
-        displayManager.showPage(currentPage, telemetryData, currentGame);
-        lastTelemetryUpdate = currentTime;
-    }
+    // Send a few more tiles of the last frame; the rest go on the next passes
+    displayManager.flushStep();
+}
+
+#ifdef ESP8266_BOARD
+// Single-threaded: one pass of each side per loop
+void loop() {
+    unsigned long currentTime = millis();
+    receiveTelemetry(currentTime);
+    updateInterface(telemetryData, currentTime);
     
-    #ifdef ESP8266_BOARD
-    // ESP8266 needs more frequent yields and shorter delays
+    // Datagrams are queued by the receive callback, so this sleep doesn't
+    // delay them; it gives the WiFi stack time and feeds the watchdog
     yield();
-    delay(5);
-    #else
-    // ESP32 can handle longer delays
-    delay(10);
-    #endif
-}
\ No newline at end of file
+    delay(1);
+}
+#else
+// Telemetry task -> render task hand-off; neither side ever blocks on it
+SnapshotBuffer<TelemetryData> telemetrySnapshot;
+
+void telemetryTask(void* parameter) {
+    (void)parameter;
+    unsigned long lastPublish = 0;
+    for (;;) {
+        unsigned long currentTime = millis();
+        // Counters and the data timeout change without new data, so publish periodically too
+        if (receiveTelemetry(currentTime) || currentTime - lastPublish > DISPLAY_REFRESH_MS) {
+            telemetrySnapshot.back() = telemetryData;
+            telemetrySnapshot.publish();
+            lastPublish = currentTime;
+        }
+        vTaskDelay(1);
+    }
+}
+
+void renderTask(void* parameter) {
+    (void)parameter;
+    for (;;) {
+        telemetrySnapshot.update();
+        updateInterface(telemetrySnapshot.front(), millis());
+        vTaskDelay(1);
+    }
+}
+
+void loop() {
+    // Everything runs in telemetryTask and renderTask
+    vTaskDelete(nullptr);
+}
+#endif
@@ -1,114 +1,467 @@
 #include "network_manager.h"
 
-NetworkManager::NetworkManager() : wifiConnected(false), lastConnectionAttempt(0) {
-}
+const NetworkManager::ListenerConfig NetworkManager::listenerConfig[UDP_SOURCE_COUNT] = {
+    { F1_UDP_PORT, "F1" },
+    { PCARS_UDP_PORT, "PCARS" },
+    { PCARS_FORWARDER_PORT, "PCARS forwarder" },
+};
 
-bool NetworkManager::begin() {
-    return connectWiFi();
+NetworkManager::NetworkManager() :
+    f1Parser(nullptr),
+    activeSources(0xFF),
+    state(WIFI_STATE_IDLE),
+    stateSince(0),
+    backoffMs(WIFI_BACKOFF_MIN_MS),
+    gotIP(false),
+    linkLost(false),
+    fastAttempt(false),
+    leaseReused(false),
+    attemptStart(0),
+    firstPacketAt(0),
+    firstPacketReported(true),
+    f1SkippedCount(0) {
+    for (uint8_t i = 0; i < UDP_SOURCE_COUNT; i++) {
+        #ifdef ESP8266_BOARD
+        listeners[i] = nullptr;
+        #endif
+        validPackets[i].store(0, std::memory_order_relaxed);
+    }
 }
 
-bool NetworkManager::connectWiFi() {
-    Serial.println("Connecting to WiFi: " + String(WIFI_SSID));
-    
+void NetworkManager::begin() {
+    // The state machine owns retries, so the SDK must not reconnect on its own
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(false);
     WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    wifiCache.begin();
     
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && (millis() - startTime) < WIFI_TIMEOUT_MS) {
-        delay(500);
-        Serial.print(".");
-        #ifdef ESP8266_BOARD
-        yield(); // ESP8266 needs yield() in loops
-        #endif
+    #ifdef ESP8266_BOARD
+    gotIPHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP&) {
+        gotIP.store(true);
+    });
+    disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected&) {
+        linkLost.store(true);
+    });
+    #else
+    WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+        (void)info;
+        if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+            gotIP.store(true);
+        } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+            linkLost.store(true);
+        }
+    });
+    #endif
+    
+    startConnect(millis());
+}
+
+// Reads and clears an event flag. A load and a store rather than exchange(),
+// which would need atomic read-modify-write support ESP8266 doesn't have;
+// its events run between loop() passes anyway.
+static bool takeFlag(std::atomic<bool>& flag) {
+    if (!flag.load()) {
+        return false;
     }
+    flag.store(false);
+    return true;
+}
+
+void NetworkManager::update(unsigned long currentTime) {
+    switch (state.load()) {
+        case WIFI_STATE_CONNECTING:
+            if (takeFlag(gotIP)) {
+                IPAddress localIP = WiFi.localIP();
+                Serial.printf("WiFi connected in %lu ms (%s)! IP address: %u.%u.%u.%u\n", currentTime - attemptStart,
+                              fastAttempt ? "cached AP" : "scan", localIP[0], localIP[1], localIP[2], localIP[3]);
+                backoffMs = WIFI_BACKOFF_MIN_MS;
+                linkLost.store(false);
+                saveAssociation();
+                firstPacketAt.store(0);
+                firstPacketReported = false;
+                setupUDP();
+                setState(WIFI_STATE_CONNECTED, currentTime);
+            } else if (fastAttempt && currentTime - stateSince > WIFI_FAST_TIMEOUT_MS) {
+                // The AP moved channel, changed BSSID or is gone - find it the slow way
+                Serial.println("WiFi: cached AP not answering, scanning");
+                WiFi.disconnect();
+                beginScanAttempt(currentTime);
+            } else if (currentTime - stateSince > WIFI_TIMEOUT_MS) {
+                Serial.println("WiFi connection failed!");
+                enterBackoff(currentTime);
+            }
+            break;
+            
+        case WIFI_STATE_CONNECTED:
+            if (!firstPacketReported) {
+                reportFirstPacket();
+            }
+            if (checkReusedLease(currentTime)) {
+                break;
+            }
+            if (takeFlag(linkLost)) {
+                Serial.println("WiFi disconnected");
+                enterBackoff(currentTime);
+            }
+            break;
+            
+        case WIFI_STATE_BACKOFF:
+            if (currentTime - stateSince >= backoffMs) {
+                backoffMs = min(backoffMs * 2, (unsigned long)WIFI_BACKOFF_MAX_MS);
+                startConnect(currentTime);
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+bool NetworkManager::isConnected() const {
+    return state.load() == WIFI_STATE_CONNECTED;
+}
+
+WiFiState NetworkManager::getState() const {
+    return static_cast<WiFiState>(state.load());
+}
+
+void NetworkManager::startConnect(unsigned long currentTime) {
+    Serial.printf("Connecting to WiFi: %s\n", WIFI_SSID);
     
-    if (WiFi.status() == WL_CONNECTED) {
-        wifiConnected = true;
-        Serial.println();
-        Serial.println("WiFi connected!");
-        Serial.println("IP address: " + WiFi.localIP().toString());
-        
-        setupUDP();
-        return true;
+    WiFiCacheEntry cached;
+    if (WIFI_FAST_CONNECT && wifiCache.load(cached)) {
+        beginFastAttempt(cached, currentTime);
     } else {
-        wifiConnected = false;
-        Serial.println();
-        Serial.println("WiFi connection failed!");
+        beginScanAttempt(currentTime);
+    }
+}
+
+// Associates straight to the cached BSSID on its channel: no scan, and with
+// WIFI_REUSE_LEASE no DHCP either
+void NetworkManager::beginFastAttempt(const WiFiCacheEntry& cached, unsigned long currentTime) {
+    Serial.printf("WiFi: trying cached AP on channel %d\n", cached.channel);
+    
+    fastAttempt = true;
+    attemptStart = currentTime;
+    gotIP.store(false);
+    configureAddress(&cached);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cached.channel, cached.bssid);
+    setState(WIFI_STATE_CONNECTING, currentTime);
+}
+
+void NetworkManager::beginScanAttempt(unsigned long currentTime) {
+    fastAttempt = false;
+    attemptStart = currentTime;
+    gotIP.store(false);
+    configureAddress(nullptr);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    setState(WIFI_STATE_CONNECTING, currentTime);
+}
+
+// WIFI_STATIC_IP if configured, else the cached lease (fast attempts only),
+// else DHCP
+void NetworkManager::configureAddress(const WiFiCacheEntry* lease) {
+    #ifdef WIFI_STATIC_IP
+    (void)lease;
+    leaseReused = false;
+    WiFi.config(IPAddress(WIFI_STATIC_IP), IPAddress(WIFI_STATIC_GATEWAY),
+                IPAddress(WIFI_STATIC_SUBNET), IPAddress(WIFI_STATIC_DNS));
+    #else
+    leaseReused = WIFI_REUSE_LEASE && lease != nullptr && lease->localIP != 0;
+    if (leaseReused) {
+        WiFi.config(IPAddress(lease->localIP), IPAddress(lease->gateway),
+                    IPAddress(lease->subnet), IPAddress(lease->dns));
+    } else {
+        // An all-zero address hands the interface back to DHCP
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    }
+    #endif
+}
+
+// A reused lease the DHCP server has since handed to someone else, or that
+// belongs to a subnet the AP no longer serves, still raises got-IP: the static
+// config doesn't ask anyone. Nothing addressed to us arrives then, so a first
+// packet is what confirms the lease. Without one in WIFI_LEASE_CHECK_MS the
+// lease is forgotten and the connection redone with a scan and DHCP. With no
+// game sending that costs one DHCP exchange, and the new lease is cached.
+bool NetworkManager::checkReusedLease(unsigned long currentTime) {
+    if (!leaseReused || firstPacketAt.load() != 0 || currentTime - stateSince <= WIFI_LEASE_CHECK_MS) {
         return false;
     }
+    Serial.println("WiFi: nothing received on the cached lease, scanning with DHCP");
+    wifiCache.forgetLease();
+    WiFi.disconnect();
+    beginScanAttempt(currentTime);
+    return true;
+}
+
+void NetworkManager::saveAssociation() {
+    WiFiCacheEntry entry;
+    entry.localIP = (uint32_t)WiFi.localIP();
+    entry.gateway = (uint32_t)WiFi.gatewayIP();
+    entry.subnet = (uint32_t)WiFi.subnetMask();
+    entry.dns = (uint32_t)WiFi.dnsIP(0);
+    memcpy(entry.bssid, WiFi.BSSID(), sizeof(entry.bssid));
+    entry.channel = WiFi.channel();
+    entry.reserved = 0;
+    wifiCache.save(entry);
+}
+
+void NetworkManager::reportFirstPacket() {
+    uint32_t arrivedAt = firstPacketAt.load();
+    if (arrivedAt == 0) {
+        return;
+    }
+    Serial.printf("WiFi: first packet %lu ms after connect start (%s)\n",
+                  (unsigned long)(arrivedAt - attemptStart), fastAttempt ? "cached AP" : "scan");
+    firstPacketReported = true;
+}
+
+void NetworkManager::enterBackoff(unsigned long currentTime) {
+    // Drop any half-open association so the next WiFi.begin() starts clean
+    WiFi.disconnect();
+    Serial.printf("WiFi: retrying in %lu ms\n", backoffMs);
+    setState(WIFI_STATE_BACKOFF, currentTime);
+}
+
+void NetworkManager::setState(WiFiState newState, unsigned long currentTime) {
+    state.store(newState);
+    stateSince = currentTime;
 }
 
 void NetworkManager::setupUDP() {
-    // Setup F1 UDP listener
-    if (f1Udp.begin(F1_UDP_PORT)) {
-        Serial.println("F1 UDP listener started on port " + String(F1_UDP_PORT));
+    for (uint8_t i = 0; i < UDP_SOURCE_COUNT; i++) {
+        bool started;
+        #ifdef ESP8266_BOARD
+        // Raw lwIP socket; a reconnect rebinds from scratch
+        if (listeners[i] != nullptr) {
+            udp_remove(listeners[i]);
+        }
+        listeners[i] = udp_new();
+        started = listeners[i] != nullptr && udp_bind(listeners[i], IP_ADDR_ANY, listenerConfig[i].port) == ERR_OK;
+        if (started) {
+            udp_recv(listeners[i], &NetworkManager::onLwipReceive, this);
+        }
+        #else
+        started = listeners[i].listen(listenerConfig[i].port);
+        if (started) {
+            listeners[i].onPacket([this, i](AsyncUDPPacket& packet) {
+                Datagram datagram = { &packet, static_cast<uint16_t>(packet.length()), packet.remoteIP(), packet.remotePort(), static_cast<uint32_t>(micros()) };
+                onDatagram(i, datagram);
+            });
+        }
+        #endif
+        
+        if (started) {
+            Serial.printf("%s UDP listener started on port %u\n", listenerConfig[i].name, listenerConfig[i].port);
+        } else {
+            Serial.printf("Failed to start %s UDP listener\n", listenerConfig[i].name);
+        }
+    }
+}
+
+void NetworkManager::setActiveSources(uint8_t mask) {
+    activeSources.store(mask, std::memory_order_relaxed);
+}
+
+uint32_t NetworkManager::getValidPacketCount(uint8_t source) const {
+    return validPackets[source].load(std::memory_order_relaxed);
+}
+
+void NetworkManager::discardQueued() {
+    f1Ring.discard();
+    #if F1_FIELD_TABLE
+    f1TableRing.discard();
+    #endif
+    pcarsRing.discard();
+}
+
+void NetworkManager::attachF1Parser(const F1TelemetryParser& parser) {
+    f1Parser = &parser;
+}
+
+#ifdef ESP8266_BOARD
+void NetworkManager::onLwipReceive(void* arg, udp_pcb* pcb, pbuf* p, const ip_addr_t* addr, u16_t port) {
+    NetworkManager* self = static_cast<NetworkManager*>(arg);
+    for (uint8_t i = 0; i < UDP_SOURCE_COUNT; i++) {
+        if (self->listeners[i] == pcb) {
+            Datagram datagram = { p, p->tot_len, IPAddress(addr), port, static_cast<uint32_t>(micros()) };
+            self->onDatagram(i, datagram);
+            break;
+        }
+    }
+    pbuf_free(p);
+}
+#endif
+
+void NetworkManager::Datagram::copy(uint8_t* dest, uint16_t offset, uint16_t length) const {
+    #ifdef ESP8266_BOARD
+    // The payload can be a pbuf chain
+    pbuf_copy_partial(buffer, dest, length, offset);
+    #else
+    memcpy(dest, packet->data() + offset, length);
+    #endif
+}
+
+// Runs in the network stack's context, not loop() - keep it short and don't print
+void NetworkManager::onDatagram(uint8_t source, const Datagram& datagram) {
+    unsigned long now = millis();
+    if (firstPacketAt.load(std::memory_order_relaxed) == 0) {
+        firstPacketAt.store(now, std::memory_order_relaxed);
+    }
+    
+    // Every listener's datagrams are header-checked and counted, selected or
+    // not, so the game selector can see which game is sending
+    uint8_t header[F1_HEADER_PEEK_SIZE];
+    bool valid;
+    if (source == UDP_SOURCE_F1) {
+        valid = datagram.size >= F1_HEADER_PEEK_SIZE;
+        if (valid) {
+            datagram.copy(header, 0, F1_HEADER_PEEK_SIZE);
+            valid = F1TelemetryParser::checkHeader(header, datagram.size);
+        }
     } else {
-        Serial.println("Failed to start F1 UDP listener");
+        datagram.copy(header, 0, min(datagram.size, (uint16_t)PCARS_HEADER_PEEK_SIZE));
+        valid = PCARSTelemetryParser::checkHeader(header, datagram.size, source);
+    }
+    if (!valid) {
+        return;
+    }
+    
+    // Other rigs on the LAN are turned away here, before they're counted or queued
+    if (!senderPins[source].admit(datagram.remoteIP, datagram.remotePort, now)) {
+        return;
     }
+    validPackets[source].store(validPackets[source].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     
-    // Setup PCARS UDP listener (broadcast)
-    if (pcarsUdp.begin(PCARS_UDP_PORT)) {
-        Serial.println("PCARS UDP listener started on port " + String(PCARS_UDP_PORT));
+    if (!(activeSources.load(std::memory_order_relaxed) & (1u << source))) {
+        return;
+    }
+    if (source == UDP_SOURCE_F1) {
+        queueF1(header, datagram);
     } else {
-        Serial.println("Failed to start PCARS UDP listener");
+        queuePCARS(source, datagram);
+    }
+}
+
+void NetworkManager::queueF1(const uint8_t* header, const Datagram& datagram) {
+    if (f1Parser == nullptr) {
+        return;
+    }
+    
+    // Let the parser decide on the header before copying any payload
+    F1ReadPlan plan;
+    if (!f1Parser->planRead(header, datagram.size, plan)) {
+        f1SkippedCount.store(f1SkippedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
     }
     
-    // Also listen on forwarder port for PCARS JSON data
-    // Note: We'll use the same pcarsUdp object and check packet content to distinguish
+    // Copy the planned ranges back to back, straight into the ring slot
+    #if F1_FIELD_TABLE
+    bool table = (F1_TABLE_PACKETS & (1u << plan.packetId)) != 0;
+    uint8_t* slot = table ? f1TableRing.beginWrite() : f1Ring.beginWrite();
+    #else
+    uint8_t* slot = f1Ring.beginWrite();
+    #endif
+    uint16_t written = 0;
+    for (uint8_t i = 0; i < plan.rangeCount; i++) {
+        datagram.copy(slot + written, plan.ranges[i].offset, plan.ranges[i].length);
+        written += plan.ranges[i].length;
+    }
+    
+    UdpDatagram queued;
+    queued.size = written;
+    queued.datagramSize = datagram.size;
+    queued.tag = plan.packetId;
+    queued.remoteIP = datagram.remoteIP;
+    queued.receivedMicros = datagram.receivedMicros;
+    #if F1_FIELD_TABLE
+    if (table) {
+        f1TableRing.commit(queued);
+        return;
+    }
+    #endif
+    f1Ring.commit(queued);
 }
 
-bool NetworkManager::isConnected() {
-    wifiConnected = (WiFi.status() == WL_CONNECTED);
-    return wifiConnected;
+void NetworkManager::queuePCARS(uint8_t source, const Datagram& datagram) {
+    // Larger packet types (participant names) aren't decoded
+    if (datagram.size > PCARS_MAX_PACKET_SIZE) {
+        return;
+    }
+    
+    datagram.copy(pcarsRing.beginWrite(), 0, datagram.size);
+    
+    UdpDatagram queued;
+    queued.size = datagram.size;
+    queued.datagramSize = datagram.size;
+    queued.tag = source;
+    queued.remoteIP = datagram.remoteIP;
+    queued.receivedMicros = datagram.receivedMicros;
+    pcarsRing.commit(queued);
 }
 
-void NetworkManager::reconnect() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastConnectionAttempt > 5000) { // Don't attempt too frequently
-        lastConnectionAttempt = currentTime;
-        
-        WiFi.disconnect();
-        delay(1000);
-        connectWiFi();
+bool NetworkManager::readF1Packet(uint8_t* buffer, uint8_t* tableBuffer, UdpDatagram& datagram) {
+    #if F1_FIELD_TABLE
+    // Oldest first across both rings, so a new session's packets never come
+    // out ahead of the old session's
+    UdpDatagram next;
+    UdpDatagram nextTable;
+    bool haveNext = f1Ring.peek(next);
+    bool read;
+    if (f1TableRing.peek(nextTable) &&
+        (!haveNext || (int32_t)(nextTable.receivedMicros - next.receivedMicros) < 0)) {
+        read = f1TableRing.read(tableBuffer, datagram);
+    } else {
+        read = haveNext && f1Ring.read(buffer, datagram);
+    }
+    if (!read) {
+        return false;
+    }
+    #else
+    (void)tableBuffer;
+    if (!f1Ring.read(buffer, datagram)) {
+        return false;
     }
+    #endif
+    
+    #if DEBUG_UDP
+    Serial.printf("F1 UDP: %d of %d bytes from %u.%u.%u.%u\n", datagram.size, datagram.datagramSize,
+                  datagram.remoteIP[0], datagram.remoteIP[1], datagram.remoteIP[2], datagram.remoteIP[3]);
+    #endif
+    
+    return true;
 }
 
-bool NetworkManager::hasF1Data() {
-    return f1Udp.parsePacket() > 0;
+unsigned long NetworkManager::getF1SkippedCount() const {
+    return f1SkippedCount.load(std::memory_order_relaxed);
 }
 
-bool NetworkManager::readF1Data(uint8_t* buffer, int& packetSize, IPAddress& sourceIP) {
-    // parsePacket() was already called in hasF1Data(), so packet is ready to read
-    packetSize = f1Udp.available();
-    if (packetSize > 0 && packetSize <= UDP_BUFFER_SIZE) {
-        sourceIP = f1Udp.remoteIP();
-        int bytesRead = f1Udp.read(buffer, packetSize);
-        
-        #if DEBUG_UDP
-        Serial.printf("F1 UDP: %d bytes from %s\n", bytesRead, sourceIP.toString().c_str());
-        #endif
-        
-        return bytesRead == packetSize;
+bool NetworkManager::readPCARSPacket(uint8_t* buffer, UdpDatagram& datagram) {
+    if (!pcarsRing.read(buffer, datagram)) {
+        return false;
     }
-    return false;
+    
+    #if DEBUG_UDP
+    Serial.printf("%s UDP: %d bytes from %u.%u.%u.%u\n", listenerConfig[datagram.tag].name, datagram.size,
+                  datagram.remoteIP[0], datagram.remoteIP[1], datagram.remoteIP[2], datagram.remoteIP[3]);
+    #endif
+    
+    return true;
 }
 
-bool NetworkManager::hasPCARSData() {
-    return pcarsUdp.parsePacket() > 0;
+uint32_t NetworkManager::getDroppedCount() const {
+    uint32_t dropped = f1Ring.getDropped() + pcarsRing.getDropped();
+    #if F1_FIELD_TABLE
+    dropped += f1TableRing.getDropped();
+    #endif
+    return dropped;
 }
 
-bool NetworkManager::readPCARSData(uint8_t* buffer, int& packetSize, IPAddress& sourceIP) {
-    // parsePacket() was already called in hasPCARSData(), so packet is ready to read
-    packetSize = pcarsUdp.available();
-    if (packetSize > 0 && packetSize <= UDP_BUFFER_SIZE) {
-        sourceIP = pcarsUdp.remoteIP();
-        int bytesRead = pcarsUdp.read(buffer, packetSize);
-        
-        #if DEBUG_UDP
-        Serial.printf("PCARS UDP: %d bytes from %s\n", bytesRead, sourceIP.toString().c_str());
-        #endif
-        
-        return bytesRead == packetSize;
+uint32_t NetworkManager::getRejectedSenderCount() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < UDP_SOURCE_COUNT; i++) {
+        total += senderPins[i].getRejectedCount();
     }
-    return false;
-}
\ No newline at end of file
+    return total;
+}
@@ -3,35 +3,144 @@
 
 #ifdef ESP8266_BOARD
     #include <ESP8266WiFi.h>
+    #include <lwip/udp.h>
 #else
     #include <WiFi.h>
+    #include <AsyncUDP.h>
 #endif
-#include <WiFiUdp.h>
+#include <atomic>
 #include "config.h"
+#include "telemetry_f1.h"
+#include "telemetry_pcars.h"
+#include "udp_ring.h"
+#include "sender_pin.h"
+#include "wifi_cache.h"
+
+// WiFi link states, driven by NetworkManager::update()
+enum WiFiState {
+    WIFI_STATE_IDLE,          // begin() not called yet
+    WIFI_STATE_CONNECTING,    // WiFi.begin() issued (cached AP or full scan), waiting for an IP
+    WIFI_STATE_CONNECTED,
+    WIFI_STATE_BACKOFF        // Waiting before the next attempt
+};
 
 class NetworkManager {
 public:
     NetworkManager();
-    bool begin();
-    bool isConnected();
-    void reconnect();
-    
-    // F1 UDP handling
-    bool hasF1Data();
-    bool readF1Data(uint8_t* buffer, int& packetSize, IPAddress& sourceIP);
-    
-    // PCARS UDP handling
-    bool hasPCARSData();
-    bool readPCARSData(uint8_t* buffer, int& packetSize, IPAddress& sourceIP);
-    
+    // Starts connecting and returns straight away; update() does the rest
+    void begin();
+    // Advances the connection state machine - never blocks, call every loop
+    void update(unsigned long currentTime);
+    bool isConnected() const;
+    WiFiState getState() const;
+
+    // Datagrams are received in the network stack's callback as soon as they
+    // arrive and queued in a ring per game; loop() drains them with the read
+    // functions below. Every listener stays open and its datagrams are
+    // header-checked and counted, but those from sources outside mask
+    // (1 << UDP_SOURCE_*) are dropped right after the check, so the game that
+    // isn't selected doesn't fill a ring.
+    void setActiveSources(uint8_t mask);
+    // Datagrams from source that passed the header check, selected or not
+    uint32_t getValidPacketCount(uint8_t source) const;
+    // Empties both rings; call from the side that reads them
+    void discardQueued();
+
+    // F1 datagrams are planned in the callback (see F1TelemetryParser::planRead),
+    // so only the wanted packets and their planned ranges are queued. Must be
+    // set before begin().
+    void attachF1Parser(const F1TelemetryParser& parser);
+
+    // Copies the oldest queued F1 packet, laid out for parseCompactPacket(),
+    // into buffer (F1_COMPACT_PACKET_SIZE bytes), or into tableBuffer
+    // (F1_TABLE_PACKET_SIZE bytes) for F1_TABLE_PACKETS; datagram.tag is the
+    // packet ID. tableBuffer is unused without F1_FIELD_TABLE.
+    bool readF1Packet(uint8_t* buffer, uint8_t* tableBuffer, UdpDatagram& datagram);
+    unsigned long getF1SkippedCount() const;
+
+    // Copies the oldest queued PCARS datagram into buffer (PCARS_MAX_PACKET_SIZE
+    // bytes); datagram.tag is the listener, UDP_SOURCE_PCARS or UDP_SOURCE_PCARS_FORWARDER
+    bool readPCARSPacket(uint8_t* buffer, UdpDatagram& datagram);
+
+    // Datagrams lost because a ring was full (oldest dropped first)
+    uint32_t getDroppedCount() const;
+    // Datagrams from senders other than the pinned one (see SenderPin)
+    uint32_t getRejectedSenderCount() const;
+
 private:
-    WiFiUDP f1Udp;
-    WiFiUDP pcarsUdp;
-    bool wifiConnected;
-    unsigned long lastConnectionAttempt;
-    
-    bool connectWiFi();
+    struct ListenerConfig {
+        uint16_t port;
+        const char* name;
+    };
+    static const ListenerConfig listenerConfig[UDP_SOURCE_COUNT];
+
+    // One datagram as the network stack hands it to the receive callback
+    struct Datagram {
+        #ifdef ESP8266_BOARD
+        pbuf* buffer;
+        #else
+        AsyncUDPPacket* packet;
+        #endif
+        uint16_t size;
+        IPAddress remoteIP;
+        uint16_t remotePort;
+        uint32_t receivedMicros;
+
+        void copy(uint8_t* dest, uint16_t offset, uint16_t length) const;
+    };
+
+    #ifdef ESP8266_BOARD
+    udp_pcb* listeners[UDP_SOURCE_COUNT];  // Indexed by UDP_SOURCE_*
+    static void onLwipReceive(void* arg, udp_pcb* pcb, pbuf* p, const ip_addr_t* addr, u16_t port);
+    #else
+    AsyncUDP listeners[UDP_SOURCE_COUNT];  // Indexed by UDP_SOURCE_*
+    #endif
+
+    UdpRing<F1_COMPACT_PACKET_SIZE, UDP_RING_SLOTS> f1Ring;
+    #if F1_FIELD_TABLE
+    UdpRing<F1_TABLE_PACKET_SIZE, F1_TABLE_RING_SLOTS> f1TableRing;  // F1_TABLE_PACKETS
+    #endif
+    UdpRing<PCARS_MAX_PACKET_SIZE, UDP_RING_SLOTS> pcarsRing;  // Both PCARS listeners
+    const F1TelemetryParser* f1Parser;
+    std::atomic<uint8_t> activeSources;
+    std::atomic<uint32_t> validPackets[UDP_SOURCE_COUNT];  // Written by the callback
+    SenderPin senderPins[UDP_SOURCE_COUNT];
+
+    // Connection state machine. The WiFi event callbacks only set the flags;
+    // update() acts on them.
+    std::atomic<uint8_t> state;            // WiFiState
+    unsigned long stateSince;
+    unsigned long backoffMs;               // Wait before the next attempt, doubles per failure
+    std::atomic<bool> gotIP;
+    std::atomic<bool> linkLost;
+    WiFiCache wifiCache;
+    bool fastAttempt;                      // Current attempt targets the cached AP
+    bool leaseReused;                      // Current attempt skipped DHCP; unconfirmed until a packet arrives
+    unsigned long attemptStart;            // Its WiFi.begin()
+    // Time to first packet is measured from attemptStart. The callback stamps
+    // firstPacketAt (0 until a datagram arrives); update() reports it once
+    // per connection.
+    std::atomic<uint32_t> firstPacketAt;
+    bool firstPacketReported;
+    #ifdef ESP8266_BOARD
+    WiFiEventHandler gotIPHandler;         // Events stay registered while these live
+    WiFiEventHandler disconnectedHandler;
+    #endif
+    std::atomic<uint32_t> f1SkippedCount;  // F1 datagrams dropped on the header peek, written by the callback
+
+    void startConnect(unsigned long currentTime);
+    void beginFastAttempt(const WiFiCacheEntry& cached, unsigned long currentTime);
+    void beginScanAttempt(unsigned long currentTime);
+    void configureAddress(const WiFiCacheEntry* lease);
+    bool checkReusedLease(unsigned long currentTime);
+    void saveAssociation();
+    void reportFirstPacket();
+    void enterBackoff(unsigned long currentTime);
+    void setState(WiFiState newState, unsigned long currentTime);
     void setupUDP();
+    void onDatagram(uint8_t source, const Datagram& datagram);
+    void queueF1(const uint8_t* header, const Datagram& datagram);
+    void queuePCARS(uint8_t source, const Datagram& datagram);
 };
 
-#endif // NETWORK_MANAGER_H
\ No newline at end of file
+#endif // NETWORK_MANAGER_H
@@ -0,0 +1,40 @@
+#include "sender_pin.h"
+
+SenderPin::SenderPin() :
+    ip(0),
+    port(0),
+    lastSeen(0),
+    pinned(false),
+    rejected(0) {
+}
+
+bool SenderPin::admit(const IPAddress& senderIP, uint16_t senderPort, unsigned long now) {
+    uint32_t address = (uint32_t)senderIP;
+    
+    #ifdef SENDER_PIN_IP
+    // Only the configured host, whatever else is on the network
+    if (address != (uint32_t)IPAddress(SENDER_PIN_IP)) {
+        rejected.store(rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    #endif
+    
+    bool match = address == ip && senderPort == port;
+    if (pinned && !match && now - lastSeen <= SENDER_PIN_TIMEOUT_MS) {
+        rejected.store(rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    // Free, or the pinned sender went quiet - this one takes over
+    if (!match) {
+        ip = address;
+        port = senderPort;
+    }
+    pinned = true;
+    lastSeen = now;
+    return true;
+}
+
+uint32_t SenderPin::getRejectedCount() const {
+    return rejected.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,35 @@
+#ifndef SENDER_PIN_H
+#define SENDER_PIN_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+// Locks one listener to a single sender, so several rigs broadcasting on the
+// same LAN don't interleave on the dashboard. The first valid sender (or,
+// with SENDER_PIN_IP, the configured host) is pinned by IP and port; another
+// rig, or a second game on the same PC, has a different one and is rejected
+// before it's queued. The session is not part of the pin: the pinned rig
+// moving from qualifying to the race keeps its IP and port, and its first
+// frames of the new session have to reach the parser. The pin is released
+// after SENDER_PIN_TIMEOUT_MS of silence from the pinned sender, e.g. when
+// that rig quits.
+//
+// admit() runs in the receive callback only; the rejected count may be read
+// from anywhere.
+class SenderPin {
+public:
+    SenderPin();
+    // True if the datagram is from the pinned sender, pinning it if the pin is free
+    bool admit(const IPAddress& ip, uint16_t port, unsigned long now);
+    uint32_t getRejectedCount() const;
+
+private:
+    uint32_t ip;
+    uint16_t port;
+    unsigned long lastSeen;
+    bool pinned;
+    std::atomic<uint32_t> rejected;
+};
+
+#endif // SENDER_PIN_H
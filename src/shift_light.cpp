@@ -0,0 +1,91 @@
+#include "shift_light.h"
+
+ShiftLight::ShiftLight() :
+    lastSource(SOURCE_NONE),
+    lastGear(0),
+    lastProgress(0.0f),
+    slope(0.0f),
+    lastSampleMicros(0),
+    cueOn(false),
+    latencyMicros(0) {
+}
+
+bool ShiftLight::addSample(int rpm, int gear, int maxRPM, int revLightsPercent, uint32_t receivedMicros) {
+    ShiftSource source;
+    float progress;
+    if (maxRPM > 0) {
+        source = SOURCE_MAX_RPM;
+        progress = rpm * 100.0f / (maxRPM * (float)SHIFT_LIGHT_RPM_PERCENT);
+    } else if (revLightsPercent > 0) {
+        source = SOURCE_REV_LIGHTS;
+        progress = revLightsPercent / (float)SHIFT_LIGHT_REV_LIGHTS_PERCENT;
+    } else {
+        reset();
+        return false;
+    }
+
+    // The slope only means something between readings of the same kind, in
+    // the same gear, close together. A gear change jumps the revs (and a
+    // downshift would fire the cue), so it starts over like a gap does.
+    uint32_t elapsed = receivedMicros - lastSampleMicros;
+    if (source != lastSource || gear != lastGear || elapsed > SHIFT_LIGHT_SAMPLE_GAP_MS * 1000UL) {
+        slope = 0.0f;
+    } else if (elapsed > 0) {
+        // Half-step smoothing: one noisy packet can't fire the cue on its own,
+        // a real change in slope is followed within a couple of packets
+        float sampleSlope = (progress - lastProgress) * 1000000.0f / elapsed;
+        slope += (sampleSlope - slope) * 0.5f;
+    }
+    lastSource = source;
+    lastGear = gear;
+    lastProgress = progress;
+    lastSampleMicros = receivedMicros;
+
+    // Only look ahead while the revs are rising; falling revs (an upshift,
+    // braking) show as they are
+    uint32_t lead = min(latencyMicros.load(std::memory_order_relaxed), (uint32_t)(SHIFT_LIGHT_MAX_LEAD_MS * 1000UL));
+    float predicted = progress;
+    if (slope > 0.0f) {
+        predicted += slope * lead / 1000000.0f;
+    }
+
+    if (predicted >= 1.0f) {
+        cueOn = true;
+    } else if (predicted < 1.0f - SHIFT_LIGHT_HYSTERESIS / 100.0f) {
+        cueOn = false;
+    }
+    return cueOn;
+}
+
+void ShiftLight::addLatencySample(uint32_t sampleMicros) {
+    // Anything over a second is a clock mix-up or a packet that sat out a
+    // WiFi drop, not the pipeline
+    if (sampleMicros > 1000000UL) {
+        return;
+    }
+
+    // Single writer, so load and store are enough; 1/8 smoothing rides out a
+    // slow flush without lagging a lasting change for long
+    uint32_t latency = latencyMicros.load(std::memory_order_relaxed);
+    if (latency == 0) {
+        latency = sampleMicros;
+    } else {
+        latency = (uint32_t)((int32_t)latency + ((int32_t)sampleMicros - (int32_t)latency) / 8);
+    }
+    latencyMicros.store(latency, std::memory_order_relaxed);
+}
+
+void ShiftLight::reset() {
+    lastSource = SOURCE_NONE;
+    lastProgress = 0.0f;
+    slope = 0.0f;
+    cueOn = false;
+}
+
+bool ShiftLight::isCueOn() const {
+    return cueOn;
+}
+
+uint32_t ShiftLight::getLatencyMicros() const {
+    return latencyMicros.load(std::memory_order_relaxed);
+}
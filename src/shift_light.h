@@ -0,0 +1,55 @@
+#ifndef SHIFT_LIGHT_H
+#define SHIFT_LIGHT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+// Decides when the dashboard shows the shift cue. By the time the cue is lit
+// the RPM it was drawn from is old: the datagram waited in the receive ring,
+// was decoded, and the bar still had to cross I2C. On a hard launch that is
+// enough to hit the limiter first. So each RPM sample is carried forward
+// along the RPM slope by the measured receive-to-panel latency, and the cue
+// comes on when that prediction reaches the shift point.
+//
+// The shift point is SHIFT_LIGHT_RPM_PERCENT of the rev limiter the game
+// reports (F1 m_maxRPM, PCARS mMaxRPM). Until it has, F1's own rev lights
+// (m_revLightsPercent) stand in, with SHIFT_LIGHT_REV_LIGHTS_PERCENT as the
+// shift point.
+//
+// addSample() runs on the receive side, addLatencySample() on the render side;
+// on ESP32 those are different tasks, so the latency is an atomic.
+class ShiftLight {
+public:
+    ShiftLight();
+
+    // One new RPM reading (revLightsPercent 0 if the game has none), with
+    // micros() when its datagram arrived. Returns whether the cue is on.
+    bool addSample(int rpm, int gear, int maxRPM, int revLightsPercent, uint32_t receivedMicros);
+
+    // Time from a datagram arriving to the RPM bar drawn from it reaching the panel
+    void addLatencySample(uint32_t sampleMicros);
+
+    // Forget the slope and turn the cue off, e.g. when the data times out
+    void reset();
+
+    bool isCueOn() const;
+    uint32_t getLatencyMicros() const;
+
+private:
+    enum ShiftSource : uint8_t {
+        SOURCE_NONE,
+        SOURCE_MAX_RPM,
+        SOURCE_REV_LIGHTS
+    };
+
+    ShiftSource lastSource;
+    int lastGear;
+    float lastProgress;           // Last sample as a fraction of the shift point
+    float slope;                  // Smoothed change in progress per second
+    uint32_t lastSampleMicros;
+    bool cueOn;
+    std::atomic<uint32_t> latencyMicros;
+};
+
+#endif // SHIFT_LIGHT_H
@@ -0,0 +1,60 @@
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Latest-value hand-off between one writer task and one reader task.
+//
+// Three copies of T: the writer fills its back buffer and publish() swaps it
+// with the shared middle one; the reader's update() swaps its front buffer
+// with the middle one if something new was published. Each copy is owned by
+// exactly one side at a time, so the reader never sees a half-written T and
+// never has to copy it twice and retry, as a seqlock reader would with a
+// TelemetryData-sized value; neither side ever waits. The reader always sees
+// the newest complete snapshot; snapshots it didn't get to are simply
+// replaced.
+template<typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() : backIndex(0), frontIndex(1), middle(2) {
+    }
+
+    // Writer: fill back(), then publish() it
+    T& back() {
+        return buffers[backIndex];
+    }
+
+    void publish() {
+        uint8_t previous = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel);
+        backIndex = previous & kIndexMask;
+    }
+
+    // Reader: picks up the newest published snapshot, if there is one.
+    // Returns true if front() changed.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & kIndexMask;
+        return true;
+    }
+
+    const T& front() const {
+        return buffers[frontIndex];
+    }
+
+private:
+    enum : uint8_t {
+        kIndexMask = 0x03,
+        kFresh = 0x04,            // Middle holds a snapshot the reader hasn't taken
+    };
+
+    T buffers[3];
+    uint8_t backIndex;            // Writer only
+    uint8_t frontIndex;           // Reader only
+    std::atomic<uint8_t> middle;  // Index of the shared buffer, plus kFresh
+};
+
+#endif // SNAPSHOT_BUFFER_H
@@ -1,122 +1,527 @@
 #include "telemetry_f1.h"
 
-F1TelemetryParser::F1TelemetryParser() : lastUpdateTime(0) {
+// The 2020 packed structures must agree with the hand-written 2020 layout
+static_assert(F1Layout<2020>::kHeaderSize == sizeof(PacketHeader), "2020 header size");
+static_assert(F1Layout<2020>::PacketId::kOffset == offsetof(PacketHeader, m_packetId), "2020 packet ID offset");
+static_assert(F1Layout<2020>::SessionUID::kOffset == offsetof(PacketHeader, m_sessionUID), "2020 session UID offset");
+static_assert(F1Layout<2020>::SequenceFrame::kOffset == offsetof(PacketHeader, m_frameIdentifier), "2020 frame identifier offset");
+static_assert(F1Layout<2020>::PlayerCarIndex::kOffset == offsetof(PacketHeader, m_playerCarIndex), "2020 player index offset");
+static_assert(F1Layout<2020>::kMotionSize == sizeof(PacketMotionData), "2020 motion size");
+static_assert(F1Layout<2020>::kSessionSize == sizeof(PacketSessionData), "2020 session size");
+static_assert(F1Layout<2020>::kLapDataSize == sizeof(PacketLapData), "2020 lap data size");
+static_assert(F1Layout<2020>::kEventSize == sizeof(PacketEventData), "2020 event size");
+static_assert(F1Layout<2020>::kParticipantsSize == sizeof(PacketParticipantsData), "2020 participants size");
+static_assert(F1Layout<2020>::kCarSetupsSize == sizeof(PacketCarSetupData), "2020 car setups size");
+static_assert(F1Layout<2020>::kCarTelemetrySize == sizeof(PacketCarTelemetryData), "2020 car telemetry size");
+static_assert(F1Layout<2020>::kCarStatusSize == sizeof(PacketCarStatusData), "2020 car status size");
+static_assert(F1Layout<2020>::kFinalClassificationSize == sizeof(PacketFinalClassificationData), "2020 final classification size");
+static_assert(F1Layout<2020>::LapCarPosition::kOffset == offsetof(LapData, m_carPosition), "2020 lap position offset");
+static_assert(F1Layout<2020>::StatusMaxRPM::kOffset == offsetof(CarStatusData, m_maxRPM), "2020 max RPM offset");
+static_assert(F1Layout<2020>::SetupFuelLoad::kOffset == offsetof(CarSetupData, m_fuelLoad), "2020 fuel load offset");
+static_assert(F1Layout<2020>::TelemetryEngineRPM::kOffset == offsetof(CarTelemetryData, m_engineRPM), "2020 engine RPM offset");
+static_assert(F1Layout<2020>::TelemetryDRS::kOffset == offsetof(CarTelemetryData, m_drs), "2020 DRS offset");
+static_assert(F1Layout<2020>::MotionGForceLateral::kOffset == offsetof(CarMotionData, m_gForceLateral), "2020 lateral g-force offset");
+static_assert(F1Layout<2020>::MotionGForceLongitudinal::kOffset == offsetof(CarMotionData, m_gForceLongitudinal), "2020 longitudinal g-force offset");
+
+// Every per-car packet is the header, a prefix, one entry per car, the trailer
+// the decoder reads and any unread tail. A wrong stride decodes the player's
+// fields from another car, so each format's sizes have to add up.
+#define F1_CHECK_CAR_ARRAY(year, packet, size, prefix, stride, trailer, unread) \
+    static_assert(F1Layout<year>::kHeaderSize + (prefix) + (stride) * F1Layout<year>::kMaxCars + \
+                  (trailer) + (unread) == F1Layout<year>::size, #year " " packet " size")
+
+#define F1_CHECK_LAYOUT(year) \
+    F1_CHECK_CAR_ARRAY(year, "motion", kMotionSize, 0, F1Layout<year>::kMotionStride, 0, \
+                       F1Layout<year>::kMotionUnreadSize); \
+    F1_CHECK_CAR_ARRAY(year, "lap data", kLapDataSize, 0, F1Layout<year>::kLapDataStride, 0, \
+                       F1Layout<year>::kLapDataUnreadSize); \
+    F1_CHECK_CAR_ARRAY(year, "car setups", kCarSetupsSize, 0, F1Layout<year>::kCarSetupsStride, 0, 0); \
+    F1_CHECK_CAR_ARRAY(year, "car telemetry", kCarTelemetrySize, 0, F1Layout<year>::kTelemetryStride, \
+                       F1Layout<year>::kTelemetryTrailerSize, F1Layout<year>::kTelemetryUnreadSize); \
+    F1_CHECK_CAR_ARRAY(year, "car status", kCarStatusSize, 0, F1Layout<year>::kCarStatusStride, 0, 0)
+
+F1_CHECK_LAYOUT(2019);
+F1_CHECK_LAYOUT(2020);
+F1_CHECK_LAYOUT(2021);
+F1_CHECK_LAYOUT(2022);
+F1_CHECK_LAYOUT(2023);
+
+// 2019 has no final classification packet
+F1_CHECK_CAR_ARRAY(2020, "final classification", kFinalClassificationSize, F1Layout<2020>::kFinalPrefixSize,
+                   F1Layout<2020>::kFinalStride, 0, 0);
+F1_CHECK_CAR_ARRAY(2021, "final classification", kFinalClassificationSize, F1Layout<2021>::kFinalPrefixSize,
+                   F1Layout<2021>::kFinalStride, 0, 0);
+F1_CHECK_CAR_ARRAY(2022, "final classification", kFinalClassificationSize, F1Layout<2022>::kFinalPrefixSize,
+                   F1Layout<2022>::kFinalStride, 0, 0);
+F1_CHECK_CAR_ARRAY(2023, "final classification", kFinalClassificationSize, F1Layout<2023>::kFinalPrefixSize,
+                   F1Layout<2023>::kFinalStride, 0, 0);
+
+#if F1_FIELD_TABLE
+static_assert(F1Layout<F1_PACKET_FORMAT_2023>::kCarTelemetrySize <= F1_TABLE_PACKET_SIZE &&
+              F1Layout<F1_PACKET_FORMAT_2020>::kLapDataSize <= F1_TABLE_PACKET_SIZE,
+              "table buffer too small for the field table packets");
+#endif
+
+F1TelemetryParser::F1TelemetryParser() : lastUpdateTime(0), activePackets(0xFFFF),
+                                         sessionUID(0), haveSession(false) {
+    resetSequence();
 }
 
 void F1TelemetryParser::begin() {
     Serial.println("F1 Telemetry Parser initialized");
     latestData = F1TelemetryData(); // Reset to defaults
+    sequenceStats = F1SequenceStats();
+    haveSession = false;
+    resetSequence();
+    
+    #if F1_FIELD_TABLE
+    fieldTable = F1FieldTable();
+    #endif
 }
 
+// Decoder dispatch table for one format, indexed by m_packetId. Sizes, strides
+// and offsets all come from F1Layout<Format>. Only the packets the pages draw
+// from have a decoder; the rest are dropped straight after the ID check.
+// F1_TABLE_PACKETS (lap data and car telemetry) read every car when the
+// field table is built.
+template<uint16_t Format>
+const F1TelemetryParser::PacketHandler F1TelemetryParser::HandlerTable<Format>::handlers[F1_PACKET_ID_COUNT] = {
+    { nullptr, 0, 0, 0, 0, false },  // Motion
+    { nullptr, 0, 0, 0, 0, false },  // Session
+    { &F1TelemetryParser::parseLapData<Format>, F1Layout<Format>::kLapDataSize,
+      0, F1Layout<Format>::kLapDataStride, 0, (F1_TABLE_PACKETS & (1u << F1_PACKET_ID_LAP_DATA)) != 0 },
+    { &F1TelemetryParser::parseEvent<Format>, F1Layout<Format>::kEventSize,
+      F1Layout<Format>::kEventPrefixSize, 0, 0, false },
+    { nullptr, 0, 0, 0, 0, false },  // Participants
+    { nullptr, 0, 0, 0, 0, false },  // Car setups
+    { &F1TelemetryParser::parseCarTelemetry<Format>, F1Layout<Format>::kCarTelemetrySize,
+      0, F1Layout<Format>::kTelemetryStride, 0, (F1_TABLE_PACKETS & (1u << F1_PACKET_ID_CAR_TELEMETRY)) != 0 },
+    { &F1TelemetryParser::parseCarStatus<Format>, F1Layout<Format>::kCarStatusSize,
+      0, F1Layout<Format>::kCarStatusStride, 0, false },
+    { nullptr, 0, 0, 0, 0, false },  // Final classification
+    { nullptr, 0, 0, 0, 0, false },  // Lobby info
+};
+
+// Packet IDs 0-8 exist in every format except final classification in 2019
+#define F1_PACKETS_2019 ((1u << F1_PACKET_ID_FINAL_CLASSIFICATION) - 1)
+#define F1_PACKETS_2020 ((1u << F1_PACKET_ID_LOBBY_INFO) - 1)
+
+#define F1_FORMAT_ENTRY(year, packets) \
+    { year, F1Layout<year>::kHeaderSize, F1Layout<year>::PacketId::kOffset, \
+      F1Layout<year>::SessionUID::kOffset, F1Layout<year>::SequenceFrame::kOffset, \
+      F1Layout<year>::PlayerCarIndex::kOffset, F1Layout<year>::kMaxCars, \
+      packets, F1TelemetryParser::HandlerTable<year>::handlers }
+
+const F1TelemetryParser::FormatInfo F1TelemetryParser::formats[F1_FORMAT_COUNT] = {
+    F1_FORMAT_ENTRY(F1_PACKET_FORMAT_2020, F1_PACKETS_2020),
+    F1_FORMAT_ENTRY(F1_PACKET_FORMAT_2019, F1_PACKETS_2019),
+    F1_FORMAT_ENTRY(F1_PACKET_FORMAT_2021, F1_PACKETS_2020),
+    F1_FORMAT_ENTRY(F1_PACKET_FORMAT_2022, F1_PACKETS_2020),
+    F1_FORMAT_ENTRY(F1_PACKET_FORMAT_2023, F1_PACKETS_2020),
+};
+
+const char* const F1TelemetryParser::packetNames[F1_PACKET_ID_COUNT] = {
+    "Motion", "Session", "LapData", "Event", "Participants",
+    "CarSetups", "CarTelemetry", "CarStatus", "FinalClass", "LobbyInfo",
+};
+
 bool F1TelemetryParser::parsePacket(const uint8_t* buffer, int size) {
     #ifdef ESP8266_BOARD
     yield();
     #endif
     
-    // Debug: Print packet size
-    #if DEBUG_UDP
-    Serial.printf("F1: Received packet size: %d bytes\n", size);
-    #endif
-
-    // Minimum size check - must have at least a header
-    if (size < sizeof(PacketHeader)) {
+    // Minimum size check - must have at least the format field
+    if (size < 2) {
+        return false;
+    }
+    
+    const FormatInfo* format = findFormat(buffer);
+    if (format == nullptr || size < format->headerSize) {
         #if DEBUG_UDP
-        Serial.printf("F1: Packet too small for header (%d < %d)\n", size, sizeof(PacketHeader));
+        Serial.printf("F1: Unsupported format or short packet (%d bytes)\n", size);
         #endif
         return false;
     }
     
-    const PacketHeader* header = reinterpret_cast<const PacketHeader*>(buffer);
+    // Reject unused packet types on the ID byte alone, before any other work
+    uint8_t packetId = buffer[format->packetIdOffset];
+    if (!acceptsPacket(format, packetId)) {
+        return false;
+    }
+    
+    const PacketHandler& handler = format->handlers[packetId];
     
     #if DEBUG_UDP
-    Serial.printf("F1: Header - Format: %d, PacketId: %d\n", header->m_packetFormat, header->m_packetId);
+    Serial.printf("F1: Received %s packet, %d bytes (format %d)\n", packetNames[packetId], size, format->format);
     #endif
 
-    if (!validateHeader(header)) {
+    if (!validateHeader(format, buffer)) {
         return false;
     }
     
-    // Only process car telemetry packets
-    if (header->m_packetId != F1_PACKET_ID_CAR_TELEMETRY) {
+    if (size < handler.minSize) {
         #if DEBUG_UDP
-        Serial.printf("F1: Ignoring non-telemetry packet (ID: %d)\n", header->m_packetId);
+        Serial.printf("F1: Packet too small for %s (%d < %d)\n", packetNames[packetId], size, handler.minSize);
         #endif
         return false;
     }
     
-    // Calculate minimum size for car telemetry packet
-    // Header + Car data for all cars + Button/MFD data
-    size_t minSize = sizeof(PacketHeader) + (sizeof(CarTelemetryData) * F1_MAX_CARS) + 7;
+    if (!checkSequence(format, buffer, packetId)) {
+        return false;
+    }
+    
+    // Locate the player's slice in the full packet
+    uint8_t playerIndex = buffer[format->playerCarIndexOffset];
+    F1PacketView view;
+    view.header = buffer;
+    view.body = buffer + format->headerSize;
+    view.cars = view.body + handler.prefixSize;
+    view.playerCar = view.cars + playerIndex * handler.carStride;
+    view.trailer = view.cars + format->maxCars * handler.carStride;
+    
+    decodePacket(format, view);
+    return true;
+}
+
+bool F1TelemetryParser::planRead(const uint8_t* header, int datagramSize, F1ReadPlan& plan) const {
+    const FormatInfo* format = findFormat(header);
+    if (format == nullptr) {
+        return false;
+    }
+    
+    uint8_t packetId = header[format->packetIdOffset];
+    if (!acceptsPacket(format, packetId)) {
+        return false;
+    }
     
-    if (size < minSize) {
+    const PacketHandler& handler = format->handlers[packetId];
+    if (!validateHeader(format, header) || datagramSize < handler.minSize) {
+        return false;
+    }
+    
+    // Header plus the body prefix, then the player's car entry (or all of
+    // them for the field table), then the trailer
+    uint8_t playerIndex = header[format->playerCarIndexOffset];
+    uint16_t carArrayOffset = format->headerSize + handler.prefixSize;
+    uint16_t carBytes = compactCarBytes(format, handler);
+    plan.rangeCount = 0;
+    plan.ranges[plan.rangeCount++] = { 0, carArrayOffset };
+    if (carBytes > 0) {
+        uint8_t firstCar = handler.allCars ? 0 : playerIndex;
+        plan.ranges[plan.rangeCount++] = {
+            static_cast<uint16_t>(carArrayOffset + firstCar * handler.carStride),
+            carBytes };
+    }
+    if (handler.trailerSize > 0) {
+        plan.ranges[plan.rangeCount++] = {
+            static_cast<uint16_t>(carArrayOffset + format->maxCars * handler.carStride),
+            handler.trailerSize };
+    }
+    plan.compactSize = carArrayOffset + carBytes + handler.trailerSize;
+    plan.datagramSize = datagramSize;
+    plan.packetId = packetId;
+    
+    return true;
+}
+
+bool F1TelemetryParser::checkHeader(const uint8_t* header, int datagramSize) {
+    const FormatInfo* format = findFormat(header);
+    if (format == nullptr || datagramSize < format->headerSize) {
+        return false;
+    }
+    
+    uint8_t packetId = header[format->packetIdOffset];
+    return packetId < F1_PACKET_ID_COUNT && (format->packetMask & (1u << packetId)) &&
+           validateHeader(format, header);
+}
+
+bool F1TelemetryParser::parseCompactPacket(const uint8_t* buffer, int size) {
+    if (!admitCompactPacket(buffer, size)) {
+        return false;
+    }
+    decodeCompactPacket(buffer);
+    return true;
+}
+
+bool F1TelemetryParser::admitCompactPacket(const uint8_t* buffer, int size) {
+    #ifdef ESP8266_BOARD
+    yield();
+    #endif
+    
+    if (size < 2) {
+        return false;
+    }
+    
+    const FormatInfo* format = findFormat(buffer);
+    if (format == nullptr || size < format->headerSize) {
+        return false;
+    }
+    
+    uint8_t packetId = buffer[format->packetIdOffset];
+    if (!acceptsPacket(format, packetId)) {
+        return false;
+    }
+    
+    const PacketHandler& handler = format->handlers[packetId];
+    uint16_t carBytes = compactCarBytes(format, handler);
+    if (size != format->headerSize + handler.prefixSize + carBytes + handler.trailerSize) {
         #if DEBUG_UDP
-        Serial.printf("F1: Packet too small for car telemetry (%d < %d)\n", size, minSize);
+        Serial.printf("F1: Compact %s packet has wrong size (%d)\n", packetNames[packetId], size);
         #endif
         return false;
     }
     
-    // Parse car telemetry data
-    const PacketCarTelemetryData* telemetryPacket = 
-        reinterpret_cast<const PacketCarTelemetryData*>(buffer);
+    return checkSequence(format, buffer, packetId);
+}
+
+void F1TelemetryParser::decodeCompactPacket(const uint8_t* buffer) {
+    // admitCompactPacket() already checked format, packet ID and size
+    const FormatInfo* format = findFormat(buffer);
+    const PacketHandler& handler = format->handlers[buffer[format->packetIdOffset]];
+    uint16_t carBytes = compactCarBytes(format, handler);
+    
+    // The receive path already validated the header when it planned the read
+    F1PacketView view;
+    view.header = buffer;
+    view.body = buffer + format->headerSize;
+    if (handler.allCars) {
+        view.cars = view.body + handler.prefixSize;
+        view.playerCar = view.cars + buffer[format->playerCarIndexOffset] * handler.carStride;
+    } else {
+        view.cars = nullptr;
+        view.playerCar = view.body + handler.prefixSize;
+    }
+    view.trailer = view.body + handler.prefixSize + carBytes;
+    
+    decodePacket(format, view);
+}
+
+void F1TelemetryParser::setWantedPackets(uint16_t mask) {
+    activePackets.store(mask, std::memory_order_relaxed);
+}
+
+uint16_t F1TelemetryParser::getWantedPackets() const {
+    return activePackets.load(std::memory_order_relaxed);
+}
+
+const F1TelemetryParser::FormatInfo* F1TelemetryParser::findFormat(const uint8_t* header) {
+    uint16_t packetFormat = F1LayoutCommon::PacketFormat::get(header);
     
-    parseCarTelemetry(telemetryPacket);
+    // 2020 comes first in the table, so the common case is a single compare
+    for (uint8_t i = 0; i < F1_FORMAT_COUNT; i++) {
+        if (formats[i].format == packetFormat) {
+            return &formats[i];
+        }
+    }
+    return nullptr;
+}
+
+uint16_t F1TelemetryParser::compactCarBytes(const FormatInfo* format, const PacketHandler& handler) {
+    return handler.allCars ? format->maxCars * handler.carStride : handler.carStride;
+}
+
+bool F1TelemetryParser::acceptsPacket(const FormatInfo* format, uint8_t packetId) const {
+    return packetId < F1_PACKET_ID_COUNT && (activePackets.load(std::memory_order_relaxed) & format->packetMask & (1u << packetId)) &&
+           format->handlers[packetId].decode != nullptr;
+}
+
+void F1TelemetryParser::decodePacket(const FormatInfo* format, const F1PacketView& view) {
+    uint8_t packetId = view.header[format->packetIdOffset];
+    (this->*format->handlers[packetId].decode)(view);
     
     lastUpdateTime = millis();
+    latestData.lastPacketId = packetId;
     latestData.dataValid = true;
     latestData.timestamp = lastUpdateTime;
-    
-    return true;
 }
 
-bool F1TelemetryParser::validateHeader(const PacketHeader* header) {
-    // Check packet format (should be 2020 for F1 2020)
-    if (header->m_packetFormat != F1_PACKET_FORMAT_2020) {
+const char* F1TelemetryParser::packetName(uint8_t packetId) {
+    if (packetId >= F1_PACKET_ID_COUNT) {
+        return "Unknown";
+    }
+    return packetNames[packetId];
+}
+
+bool F1TelemetryParser::validateHeader(const FormatInfo* format, const uint8_t* header) {
+    // Check player car index is valid for this format's grid size
+    uint8_t playerIndex = header[format->playerCarIndexOffset];
+    if (playerIndex >= format->maxCars) {
         #if DEBUG_UDP
-        Serial.printf("F1: Invalid packet format (%d, expected %d)\n", 
-                     header->m_packetFormat, F1_PACKET_FORMAT_2020);
+        Serial.printf("F1: Invalid player car index (%d)\n", playerIndex);
         #endif
         return false;
     }
     
-    // Check player car index is valid
-    if (header->m_playerCarIndex >= F1_MAX_CARS) {
-        #if DEBUG_UDP
-        Serial.printf("F1: Invalid player car index (%d)\n", header->m_playerCarIndex);
-        #endif
+    return true;
+}
+
+bool F1TelemetryParser::checkSequence(const FormatInfo* format, const uint8_t* header, uint8_t packetId) {
+    // A new session UID means a new session - nothing from the old one applies
+    uint64_t uid = loadLE<uint64_t>(header + format->sessionUIDOffset);
+    if (!haveSession || uid != sessionUID) {
+        if (haveSession) {
+            sequenceStats.sessionChanges++;
+            latestData = F1TelemetryData();
+            #if F1_FIELD_TABLE
+            fieldTable = F1FieldTable();
+            #endif
+            
+            #if DEBUG_UDP
+            Serial.println("F1: Session changed, state reset");
+            #endif
+        }
+        resetSequence();
+        sessionUID = uid;
+        haveSession = true;
+    }
+    
+    // Events are one-offs and several can share a frame
+    if (packetId == F1_PACKET_ID_EVENT) {
+        return true;
+    }
+    
+    SequenceState& state = sequence[packetId];
+    uint32_t frame = loadLE<uint32_t>(header + format->sequenceFrameOffset);
+    if (!state.seen) {
+        state.lastFrame = frame;
+        state.seen = true;
+        return true;
+    }
+    
+    if (frame == state.lastFrame) {
+        sequenceStats.duplicates++;
         return false;
     }
     
+    if (frame < state.lastFrame) {
+        if (state.lastFrame - frame <= F1_SEQUENCE_REWIND_FRAMES) {
+            // Late datagram - decoding it would roll gear and RPM backwards
+            sequenceStats.reordered++;
+            #if DEBUG_UDP
+            Serial.printf("F1: Dropped late %s frame %u (newest %u)\n", packetNames[packetId], frame, state.lastFrame);
+            #endif
+            return false;
+        }
+        
+        // The game rewound - start tracking again from here
+        state.lastFrame = frame;
+        state.interval = 0;
+        return true;
+    }
+    
+    // Learn the send interval as the smallest step, then count whole missing steps
+    uint32_t step = frame - state.lastFrame;
+    if (state.interval == 0 || step < state.interval) {
+        state.interval = step > 0xFFFF ? 0xFFFF : step;
+    } else if (step >= 2u * state.interval) {
+        sequenceStats.lost += step / state.interval - 1;
+    }
+    state.lastFrame = frame;
+    
     return true;
 }
 
-void F1TelemetryParser::parseCarTelemetry(const PacketCarTelemetryData* packet) {
-    // Get player car index from header
-    uint8_t playerIndex = packet->m_header.m_playerCarIndex;
+void F1TelemetryParser::resetSequence() {
+    memset(sequence, 0, sizeof(sequence));
+}
+
+// 2019/2020 send lap times as float seconds, 2021 onwards as uint32 milliseconds;
+// the field's type picks the overload
+static inline float lapSeconds(float seconds) {
+    return seconds;
+}
+
+static inline float lapSeconds(uint32_t milliseconds) {
+    return milliseconds / 1000.0f;
+}
+
+template<uint16_t Format>
+void F1TelemetryParser::parseLapData(const F1PacketView& view) {
+    typedef F1Layout<Format> L;
+    static_assert(fieldFits<typename L::LapCurrentLapNum>(L::kLapDataStride), "lap field outside car entry");
+    const uint8_t* lap = view.playerCar;
     
-    // Extract telemetry data for player car
-    const CarTelemetryData& carData = packet->m_carTelemetryData[playerIndex];
+    latestData.lastLapTime = lapSeconds(L::LapLastLapTime::get(lap));
+    latestData.position = L::LapCarPosition::get(lap);
     
-    // Parse speed (uint16_t in km/h)
-    latestData.speed = static_cast<float>(carData.m_speed);
+    #if F1_FIELD_TABLE
+    if (view.cars != nullptr) {
+        const uint8_t* car = view.cars;
+        for (uint8_t i = 0; i < L::kMaxCars; i++, car += L::kLapDataStride) {
+            fieldTable.position[i] = L::LapCarPosition::get(car);
+            fieldTable.currentLap[i] = L::LapCurrentLapNum::get(car);
+        }
+        fieldTable.carCount = L::kMaxCars;
+    }
+    #endif
     
-    // Parse gear (int8_t: 1-8, N=0, R=-1)
-    latestData.gear = static_cast<int>(carData.m_gear);
+    #if DEBUG_UDP
+    Serial.printf("F1 Parsed: LastLap=%.3f, Pos=%d\n", latestData.lastLapTime, latestData.position);
+    #endif
+}
+
+template<uint16_t Format>
+void F1TelemetryParser::parseEvent(const F1PacketView& view) {
+    typedef F1Layout<Format> L;
+    const uint8_t* code = view.body + L::kEventCode;
     
-    // Parse engine RPM (uint16_t)
-    latestData.engineRPM = static_cast<int>(carData.m_engineRPM);
+    // A new session starts from scratch - drop lap and fuel state from the last one
+    if (memcmp(code, "SSTA", 4) == 0) {
+        latestData.lastLapTime = 0.0f;
+        latestData.position = 0;
+        latestData.fuelInTank = 0.0f;
+        latestData.fuelCapacity = 0.0f;
+    }
+}
+
+template<uint16_t Format>
+void F1TelemetryParser::parseCarTelemetry(const F1PacketView& view) {
+    typedef F1Layout<Format> L;
+    static_assert(fieldFits<typename L::TelemetryRevLights>(L::kTelemetryStride), "telemetry field outside car entry");
+    const uint8_t* car = view.playerCar;
+    
+    // Speed in km/h, gear 1-8 with N=0 and R=-1
+    latestData.speed = static_cast<float>(L::TelemetrySpeed::get(car));
+    latestData.gear = L::TelemetryGear::get(car);
+    latestData.engineRPM = L::TelemetryEngineRPM::get(car);
+    latestData.revLightsPercent = L::TelemetryRevLights::get(car);
+    latestData.engineSamples++;
+    
+    #if F1_FIELD_TABLE
+    static_assert(fieldFits<typename L::TelemetryDRS>(L::kTelemetryStride), "telemetry field outside car entry");
+    if (view.cars != nullptr) {
+        const uint8_t* entry = view.cars;
+        for (uint8_t i = 0; i < L::kMaxCars; i++, entry += L::kTelemetryStride) {
+            fieldTable.speed[i] = L::TelemetrySpeed::get(entry);
+            fieldTable.gear[i] = L::TelemetryGear::get(entry);
+            fieldTable.engineRPM[i] = L::TelemetryEngineRPM::get(entry);
+            fieldTable.throttle[i] = static_cast<uint8_t>(L::TelemetryThrottle::get(entry) * 100.0f + 0.5f);
+            fieldTable.brake[i] = static_cast<uint8_t>(L::TelemetryBrake::get(entry) * 100.0f + 0.5f);
+            fieldTable.drs[i] = L::TelemetryDRS::get(entry);
+        }
+        fieldTable.carCount = L::kMaxCars;
+    }
+    #endif
     
-    // Parse throttle and brake (float 0.0-1.0)
-    latestData.throttle = carData.m_throttle;
-    latestData.brake = carData.m_brake;
+    #if DEBUG_UDP
+    Serial.printf("F1 Parsed: Speed=%.1f km/h, Gear=%d, RPM=%d\n",
+                 latestData.speed, latestData.gear, latestData.engineRPM);
+    #endif
+}
+
+template<uint16_t Format>
+void F1TelemetryParser::parseCarStatus(const F1PacketView& view) {
+    typedef F1Layout<Format> L;
+    static_assert(fieldFits<typename L::StatusMaxRPM>(L::kCarStatusStride), "status field outside car entry");
+    const uint8_t* status = view.playerCar;
     
-    // Note: F1 2020 car telemetry packet doesn't include fuel or lap time
-    // These would come from other packet types (Car Status, Lap Data)
-    // For now, we'll keep previous values or set defaults
+    latestData.fuelInTank = L::StatusFuelInTank::get(status);
+    latestData.fuelCapacity = L::StatusFuelCapacity::get(status);
+    latestData.maxRPM = L::StatusMaxRPM::get(status);
     
     #if DEBUG_UDP
-    Serial.printf("F1 Parsed: Speed=%.1f km/h, Gear=%d, RPM=%d, Throttle=%.2f, Brake=%.2f\n",
-                 latestData.speed, latestData.gear, latestData.engineRPM, 
-                 latestData.throttle, latestData.brake);
+    Serial.printf("F1 Parsed: Fuel=%.2f/%.2f kg, MaxRPM=%d\n",
+                 latestData.fuelInTank, latestData.fuelCapacity, latestData.maxRPM);
     #endif
 }
 
@@ -124,25 +529,17 @@ F1TelemetryData F1TelemetryParser::getLatestData() const {
     return latestData;
 }
 
-bool F1TelemetryParser::isDataValid() const {
-    // Data is valid if we received it recently (within 2 seconds)
-    return latestData.dataValid && (millis() - lastUpdateTime < 2000);
+F1SequenceStats F1TelemetryParser::getSequenceStats() const {
+    return sequenceStats;
 }
 
-// Helper functions for endian handling (F1 data is little-endian)
-uint16_t F1TelemetryParser::readUint16LE(const uint8_t* data) {
-    return data[0] | (data[1] << 8);
+#if F1_FIELD_TABLE
+const F1FieldTable& F1TelemetryParser::getFieldTable() const {
+    return fieldTable;
 }
+#endif
 
-uint32_t F1TelemetryParser::readUint32LE(const uint8_t* data) {
-    return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+bool F1TelemetryParser::isDataValid() const {
+    // Data is valid if we received it recently (within 2 seconds)
+    return latestData.dataValid && (millis() - lastUpdateTime < 2000);
 }
-
-float F1TelemetryParser::readFloatLE(const uint8_t* data) {
-    union {
-        uint32_t i;
-        float f;
-    } converter;
-    converter.i = readUint32LE(data);
-    return converter.f;
-}
\ No newline at end of file
@@ -2,13 +2,35 @@
 #define TELEMETRY_F1_H
 
 #include <Arduino.h>
+#include <atomic>
 #include "config.h"
+#include "f1_layouts.h"
 
-// F1 2020 Constants
+// F1 Constants
+#define F1_PACKET_FORMAT_2019 2019
 #define F1_PACKET_FORMAT_2020 2020
+#define F1_PACKET_FORMAT_2021 2021
+#define F1_PACKET_FORMAT_2022 2022
+#define F1_PACKET_FORMAT_2023 2023
+#define F1_FORMAT_COUNT 5
 #define F1_MAX_CARS 22
+
+// Packet IDs (unchanged 2019-2023)
+#define F1_PACKET_ID_MOTION 0
+#define F1_PACKET_ID_SESSION 1
+#define F1_PACKET_ID_LAP_DATA 2
+#define F1_PACKET_ID_EVENT 3
+#define F1_PACKET_ID_PARTICIPANTS 4
+#define F1_PACKET_ID_CAR_SETUPS 5
 #define F1_PACKET_ID_CAR_TELEMETRY 6
+#define F1_PACKET_ID_CAR_STATUS 7
+#define F1_PACKET_ID_FINAL_CLASSIFICATION 8
+#define F1_PACKET_ID_LOBBY_INFO 9
+#define F1_PACKET_ID_COUNT 10
 
+// F1 2020 packet structures. These document the 2020 layout and cross-check
+// F1Layout<2020>; decoding goes through the LEField accessors in f1_layouts.h
+// and never casts the receive buffer to these types.
 #pragma pack(push, 1)
 
 // Packet Header (24 bytes)
@@ -54,21 +76,334 @@ struct PacketCarTelemetryData {
     int8_t          m_suggestedGear;        // Suggested gear for the player (1-8)
 };
 
+// Car Motion Data (60 bytes per car)
+struct CarMotionData {
+    float    m_worldPositionX;           // World space X position
+    float    m_worldPositionY;           // World space Y position
+    float    m_worldPositionZ;           // World space Z position
+    float    m_worldVelocityX;           // Velocity in world space X
+    float    m_worldVelocityY;           // Velocity in world space Y
+    float    m_worldVelocityZ;           // Velocity in world space Z
+    int16_t  m_worldForwardDirX;         // World space forward X direction (normalised)
+    int16_t  m_worldForwardDirY;         // World space forward Y direction (normalised)
+    int16_t  m_worldForwardDirZ;         // World space forward Z direction (normalised)
+    int16_t  m_worldRightDirX;           // World space right X direction (normalised)
+    int16_t  m_worldRightDirY;           // World space right Y direction (normalised)
+    int16_t  m_worldRightDirZ;           // World space right Z direction (normalised)
+    float    m_gForceLateral;            // Lateral G-Force component
+    float    m_gForceLongitudinal;       // Longitudinal G-Force component
+    float    m_gForceVertical;           // Vertical G-Force component
+    float    m_yaw;                      // Yaw angle in radians
+    float    m_pitch;                    // Pitch angle in radians
+    float    m_roll;                     // Roll angle in radians
+};
+
+// Motion Packet (player-only extra data follows the car array)
+struct PacketMotionData {
+    PacketHeader  m_header;                      // Header
+    CarMotionData m_carMotionData[F1_MAX_CARS];  // Data for all cars on track
+    float         m_suspensionPosition[4];       // RL, RR, FL, FR
+    float         m_suspensionVelocity[4];       // RL, RR, FL, FR
+    float         m_suspensionAcceleration[4];   // RL, RR, FL, FR
+    float         m_wheelSpeed[4];               // Speed of each wheel
+    float         m_wheelSlip[4];                // Slip ratio for each wheel
+    float         m_localVelocityX;              // Velocity in local space
+    float         m_localVelocityY;              // Velocity in local space
+    float         m_localVelocityZ;              // Velocity in local space
+    float         m_angularVelocityX;            // Angular velocity x-component
+    float         m_angularVelocityY;            // Angular velocity y-component
+    float         m_angularVelocityZ;            // Angular velocity z-component
+    float         m_angularAccelerationX;        // Angular acceleration x-component
+    float         m_angularAccelerationY;        // Angular acceleration y-component
+    float         m_angularAccelerationZ;        // Angular acceleration z-component
+    float         m_frontWheelsAngle;            // Current front wheels angle in radians
+};
+
+struct MarshalZone {
+    float  m_zoneStart;                  // Fraction (0..1) of way through the lap
+    int8_t m_zoneFlag;                   // -1 = invalid/unknown, 0 = none, 1 = green, 2 = blue, 3 = yellow, 4 = red
+};
+
+struct WeatherForecastSample {
+    uint8_t m_sessionType;               // Session type of the forecast
+    uint8_t m_timeOffset;                // Time in minutes the forecast is for
+    uint8_t m_weather;                   // 0 = clear ... 5 = storm
+    int8_t  m_trackTemperature;          // Track temp. in degrees celsius
+    int8_t  m_airTemperature;            // Air temp. in degrees celsius
+};
+
+// Session Packet
+struct PacketSessionData {
+    PacketHeader m_header;               // Header
+    uint8_t  m_weather;                  // 0 = clear ... 5 = storm
+    int8_t   m_trackTemperature;         // Track temp. in degrees celsius
+    int8_t   m_airTemperature;           // Air temp. in degrees celsius
+    uint8_t  m_totalLaps;                // Total number of laps in this race
+    uint16_t m_trackLength;              // Track length in metres
+    uint8_t  m_sessionType;              // 0 = unknown, 1 = P1 ... 12 = Time Trial
+    int8_t   m_trackId;                  // -1 for unknown
+    uint8_t  m_formula;                  // 0 = F1 Modern, 1 = F1 Classic, 2 = F2, 3 = F1 Generic
+    uint16_t m_sessionTimeLeft;          // Time left in session in seconds
+    uint16_t m_sessionDuration;          // Session duration in seconds
+    uint8_t  m_pitSpeedLimit;            // Pit speed limit in km/h
+    uint8_t  m_gamePaused;               // Whether the game is paused
+    uint8_t  m_isSpectating;             // Whether the player is spectating
+    uint8_t  m_spectatorCarIndex;        // Index of the car being spectated
+    uint8_t  m_sliProNativeSupport;      // SLI Pro support, 0 = inactive, 1 = active
+    uint8_t  m_numMarshalZones;          // Number of marshal zones to follow
+    MarshalZone m_marshalZones[21];      // List of marshal zones - max 21
+    uint8_t  m_safetyCarStatus;          // 0 = no safety car, 1 = full, 2 = virtual
+    uint8_t  m_networkGame;              // 0 = offline, 1 = online
+    uint8_t  m_numWeatherForecastSamples; // Number of weather samples to follow
+    WeatherForecastSample m_weatherForecastSamples[20]; // Array of weather forecast samples
+};
+
+// Lap Data (53 bytes per car)
+struct LapData {
+    float    m_lastLapTime;              // Last lap time in seconds
+    float    m_currentLapTime;           // Current time around the lap in seconds
+    uint16_t m_sector1TimeInMS;          // Sector 1 time in milliseconds
+    uint16_t m_sector2TimeInMS;          // Sector 2 time in milliseconds
+    float    m_bestLapTime;              // Best lap time of the session in seconds
+    uint8_t  m_bestLapNum;               // Lap number best time achieved on
+    uint16_t m_bestLapSector1TimeInMS;   // Sector 1 time of best lap in the session
+    uint16_t m_bestLapSector2TimeInMS;   // Sector 2 time of best lap in the session
+    uint16_t m_bestLapSector3TimeInMS;   // Sector 3 time of best lap in the session
+    uint16_t m_bestOverallSector1TimeInMS; // Best overall sector 1 time of the session
+    uint8_t  m_bestOverallSector1LapNum; // Lap number best overall sector 1 time achieved on
+    uint16_t m_bestOverallSector2TimeInMS; // Best overall sector 2 time of the session
+    uint8_t  m_bestOverallSector2LapNum; // Lap number best overall sector 2 time achieved on
+    uint16_t m_bestOverallSector3TimeInMS; // Best overall sector 3 time of the session
+    uint8_t  m_bestOverallSector3LapNum; // Lap number best overall sector 3 time achieved on
+    float    m_lapDistance;              // Distance vehicle is around current lap in metres
+    float    m_totalDistance;            // Total distance travelled in session in metres
+    float    m_safetyCarDelta;           // Delta in seconds for safety car
+    uint8_t  m_carPosition;              // Car race position
+    uint8_t  m_currentLapNum;            // Current lap number
+    uint8_t  m_pitStatus;                // 0 = none, 1 = pitting, 2 = in pit area
+    uint8_t  m_sector;                   // 0 = sector1, 1 = sector2, 2 = sector3
+    uint8_t  m_currentLapInvalid;        // 0 = valid, 1 = invalid
+    uint8_t  m_penalties;                // Accumulated time penalties in seconds
+    uint8_t  m_gridPosition;             // Grid position the vehicle started the race in
+    uint8_t  m_driverStatus;             // 0 = in garage, 1 = flying lap, 2 = in lap, 3 = out lap, 4 = on track
+    uint8_t  m_resultStatus;             // 0 = invalid ... 3 = active, 4 = finished, ...
+};
+
+struct PacketLapData {
+    PacketHeader m_header;               // Header
+    LapData      m_lapData[F1_MAX_CARS]; // Lap data for all cars on track
+};
+
+// Event Packet (details are a union, decoded per event code)
+struct PacketEventData {
+    PacketHeader m_header;               // Header
+    uint8_t      m_eventStringCode[4];   // Event string code, e.g. "SSTA"
+    uint8_t      m_eventDetails[7];      // Event details - interpret depending on code
+};
+
+// Participant Data (54 bytes per car)
+struct ParticipantData {
+    uint8_t m_aiControlled;              // Whether the vehicle is AI (1) or Human (0) controlled
+    uint8_t m_driverId;                  // Driver id - see appendix
+    uint8_t m_teamId;                    // Team id - see appendix
+    uint8_t m_raceNumber;                // Race number of the car
+    uint8_t m_nationality;               // Nationality of the driver
+    char    m_name[48];                  // Name of participant in UTF-8 format
+    uint8_t m_yourTelemetry;             // The player's UDP setting, 0 = restricted, 1 = public
+};
+
+struct PacketParticipantsData {
+    PacketHeader    m_header;                        // Header
+    uint8_t         m_numActiveCars;                 // Number of active cars in the data
+    ParticipantData m_participants[F1_MAX_CARS];     // Participant data for all cars
+};
+
+// Car Setup Data (49 bytes per car)
+struct CarSetupData {
+    uint8_t m_frontWing;                 // Front wing aero
+    uint8_t m_rearWing;                  // Rear wing aero
+    uint8_t m_onThrottle;                // Differential adjustment on throttle (percentage)
+    uint8_t m_offThrottle;               // Differential adjustment off throttle (percentage)
+    float   m_frontCamber;               // Front camber angle (suspension geometry)
+    float   m_rearCamber;                // Rear camber angle (suspension geometry)
+    float   m_frontToe;                  // Front toe angle (suspension geometry)
+    float   m_rearToe;                   // Rear toe angle (suspension geometry)
+    uint8_t m_frontSuspension;           // Front suspension
+    uint8_t m_rearSuspension;            // Rear suspension
+    uint8_t m_frontAntiRollBar;          // Front anti-roll bar
+    uint8_t m_rearAntiRollBar;           // Rear anti-roll bar
+    uint8_t m_frontSuspensionHeight;     // Front ride height
+    uint8_t m_rearSuspensionHeight;      // Rear ride height
+    uint8_t m_brakePressure;             // Brake pressure (percentage)
+    uint8_t m_brakeBias;                 // Brake bias (percentage)
+    float   m_rearLeftTyrePressure;      // Rear left tyre pressure (PSI)
+    float   m_rearRightTyrePressure;     // Rear right tyre pressure (PSI)
+    float   m_frontLeftTyrePressure;     // Front left tyre pressure (PSI)
+    float   m_frontRightTyrePressure;    // Front right tyre pressure (PSI)
+    uint8_t m_ballast;                   // Ballast
+    float   m_fuelLoad;                  // Fuel load
+};
+
+struct PacketCarSetupData {
+    PacketHeader m_header;                       // Header
+    CarSetupData m_carSetups[F1_MAX_CARS];       // Setup data for all cars
+};
+
+// Car Status Data (60 bytes per car)
+struct CarStatusData {
+    uint8_t  m_tractionControl;          // 0 (off) - 2 (high)
+    uint8_t  m_antiLockBrakes;           // 0 (off) - 1 (on)
+    uint8_t  m_fuelMix;                  // Fuel mix - 0 = lean, 1 = standard, 2 = rich, 3 = max
+    uint8_t  m_frontBrakeBias;           // Front brake bias (percentage)
+    uint8_t  m_pitLimiterStatus;         // Pit limiter status - 0 = off, 1 = on
+    float    m_fuelInTank;               // Current fuel mass (kg)
+    float    m_fuelCapacity;             // Fuel capacity (kg)
+    float    m_fuelRemainingLaps;        // Fuel remaining in terms of laps (value on MFD)
+    uint16_t m_maxRPM;                   // Cars max RPM, point of rev limiter
+    uint16_t m_idleRPM;                  // Cars idle RPM
+    uint8_t  m_maxGears;                 // Maximum number of gears
+    uint8_t  m_drsAllowed;               // 0 = not allowed, 1 = allowed, -1 = unknown
+    uint16_t m_drsActivationDistance;    // 0 = DRS not available, non-zero = DRS available in [X] metres
+    uint8_t  m_tyresWear[4];             // Tyre wear percentage
+    uint8_t  m_actualTyreCompound;       // Actual tyre compound, see appendix
+    uint8_t  m_visualTyreCompound;       // Visual tyre compound, see appendix
+    uint8_t  m_tyresAgeLaps;             // Age in laps of the current set of tyres
+    uint8_t  m_tyresDamage[4];           // Tyre damage (percentage)
+    uint8_t  m_frontLeftWingDamage;      // Front left wing damage (percentage)
+    uint8_t  m_frontRightWingDamage;     // Front right wing damage (percentage)
+    uint8_t  m_rearWingDamage;           // Rear wing damage (percentage)
+    uint8_t  m_drsFault;                 // Indicator for DRS fault, 0 = OK, 1 = fault
+    uint8_t  m_engineDamage;             // Engine damage (percentage)
+    uint8_t  m_gearBoxDamage;            // Gear box damage (percentage)
+    int8_t   m_vehicleFiaFlags;          // -1 = invalid/unknown, 0 = none, 1 = green, 2 = blue, 3 = yellow, 4 = red
+    float    m_ersStoreEnergy;           // ERS energy store in Joules
+    uint8_t  m_ersDeployMode;            // ERS deployment mode, 0 = none, 1 = medium, 2 = overtake, 3 = hotlap
+    float    m_ersHarvestedThisLapMGUK;  // ERS energy harvested this lap by MGU-K
+    float    m_ersHarvestedThisLapMGUH;  // ERS energy harvested this lap by MGU-H
+    float    m_ersDeployedThisLap;       // ERS energy deployed this lap
+};
+
+struct PacketCarStatusData {
+    PacketHeader  m_header;                          // Header
+    CarStatusData m_carStatusData[F1_MAX_CARS];      // Status data for all cars
+};
+
+// Final Classification Data (37 bytes per car)
+struct FinalClassificationData {
+    uint8_t m_position;                  // Finishing position
+    uint8_t m_numLaps;                   // Number of laps completed
+    uint8_t m_gridPosition;              // Grid position of the car
+    uint8_t m_points;                    // Number of points scored
+    uint8_t m_numPitStops;               // Number of pit stops made
+    uint8_t m_resultStatus;              // Result status - 3 = active, 4 = finished, ...
+    float   m_bestLapTime;               // Best lap time of the session in seconds
+    double  m_totalRaceTime;             // Total race time in seconds without penalties
+    uint8_t m_penaltiesTime;             // Total penalties accumulated in seconds
+    uint8_t m_numPenalties;              // Number of penalties applied to this driver
+    uint8_t m_numTyreStints;             // Number of tyres stints up to maximum
+    uint8_t m_tyreStintsActual[8];       // Actual tyres used by this driver
+    uint8_t m_tyreStintsVisual[8];       // Visual tyres used by this driver
+};
+
+struct PacketFinalClassificationData {
+    PacketHeader            m_header;                        // Header
+    uint8_t                 m_numCars;                       // Number of cars in the final classification
+    FinalClassificationData m_classificationData[F1_MAX_CARS];
+};
+
 #pragma pack(pop)
 
+static_assert(sizeof(PacketHeader) == 24, "F1 2020 header is 24 bytes");
+static_assert(sizeof(PacketMotionData) == 1464, "F1 2020 motion packet is 1464 bytes");
+static_assert(sizeof(PacketSessionData) == 251, "F1 2020 session packet is 251 bytes");
+static_assert(sizeof(PacketLapData) == 1190, "F1 2020 lap data packet is 1190 bytes");
+static_assert(sizeof(PacketEventData) == 35, "F1 2020 event packet is 35 bytes");
+static_assert(sizeof(PacketParticipantsData) == 1213, "F1 2020 participants packet is 1213 bytes");
+static_assert(sizeof(PacketCarSetupData) == 1102, "F1 2020 car setups packet is 1102 bytes");
+static_assert(sizeof(PacketCarTelemetryData) == 1307, "F1 2020 car telemetry packet is 1307 bytes");
+static_assert(sizeof(PacketCarStatusData) == 1344, "F1 2020 car status packet is 1344 bytes");
+static_assert(sizeof(PacketFinalClassificationData) == 839, "F1 2020 final classification packet is 839 bytes");
+
 // Simplified telemetry data for display
 struct F1TelemetryData {
-    float speed = 0.0f;           // km/h
-    int gear = 0;                 // Current gear
-    int engineRPM = 0;            // Engine RPM
-    float throttle = 0.0f;        // Throttle position (0-1)
-    float brake = 0.0f;           // Brake position (0-1)
-    float fuelInTank = 0.0f;      // Fuel remaining (from car status packet)
-    float lastLapTime = 0.0f;     // Last lap time (from lap data packet)
+    float speed = 0.0f;           // km/h (car telemetry packet)
+    int gear = 0;                 // Current gear (car telemetry packet)
+    int engineRPM = 0;            // Engine RPM (car telemetry packet)
+    int revLightsPercent = 0;     // Game's rev lights, 0-100 % (car telemetry packet)
+    uint32_t engineSamples = 0;   // Car telemetry packets decoded, so a new RPM reading shows as a change
+    float fuelInTank = 0.0f;      // Fuel remaining in kg (car status packet)
+    float fuelCapacity = 0.0f;    // Tank capacity in kg (car status packet)
+    int maxRPM = 0;               // Rev limiter RPM (car status packet)
+    float lastLapTime = 0.0f;     // Last lap time (lap data packet)
+    int position = 0;             // Race position (lap data packet)
+    uint8_t lastPacketId = 0;     // Packet ID of the most recently decoded packet
     bool dataValid = false;       // Data validity flag
     unsigned long timestamp = 0;   // When data was received
 };
 
+#if F1_FIELD_TABLE
+// Whole-field data from the per-car arrays, one array per field indexed by
+// car. Each packet refreshes its columns in one pass over the car entries.
+struct F1FieldTable {
+    uint8_t carCount = 0;                // Valid entries (the format's grid size)
+    uint16_t speed[F1_MAX_CARS] = {};    // km/h (car telemetry packet)
+    int8_t gear[F1_MAX_CARS] = {};       // N = 0, R = -1 (car telemetry packet)
+    uint16_t engineRPM[F1_MAX_CARS] = {};// (car telemetry packet)
+    uint8_t throttle[F1_MAX_CARS] = {};  // 0-100 % (car telemetry packet)
+    uint8_t brake[F1_MAX_CARS] = {};     // 0-100 % (car telemetry packet)
+    uint8_t drs[F1_MAX_CARS] = {};       // 0 = off, 1 = on (car telemetry packet)
+    uint8_t position[F1_MAX_CARS] = {};  // Race position, 0 = unknown (lap data packet)
+    uint8_t currentLap[F1_MAX_CARS] = {};// (lap data packet)
+};
+#endif
+
+// Frame sequencing counters. Each packet type is tracked on its own, since
+// the game sends them at different rates.
+struct F1SequenceStats {
+    uint32_t lost = 0;            // Frames skipped, estimated from each type's send interval
+    uint32_t reordered = 0;       // Older than a frame already decoded - dropped
+    uint32_t duplicates = 0;      // Same frame decoded already - dropped
+    uint32_t sessionChanges = 0;  // m_sessionUID changed and state was reset
+};
+
+// Byte ranges of an F1 datagram the parser needs. The receive path reads the
+// header, asks the parser for a plan, then copies only these ranges into a
+// compact buffer laid out as [header][body prefix][player car][trailer].
+#define F1_READ_PLAN_MAX_RANGES 3
+#define F1_COMPACT_PACKET_SIZE 128
+
+// With F1_FIELD_TABLE, the packets feeding the table copy every car's entry
+// instead of the player's; only they get buffers of F1_TABLE_PACKET_SIZE
+#if F1_FIELD_TABLE
+#define F1_TABLE_PACKETS ((1u << F1_PACKET_ID_LAP_DATA) | (1u << F1_PACKET_ID_CAR_TELEMETRY))
+#define F1_TABLE_PACKET_COUNT 2
+#define F1_TABLE_PACKET_SIZE 1352
+#else
+#define F1_TABLE_PACKETS 0u
+#define F1_TABLE_PACKET_COUNT 0
+#endif
+
+struct F1ReadPlan {
+    struct Range {
+        uint16_t offset;          // Offset in the datagram
+        uint16_t length;          // Bytes to copy
+    };
+    Range ranges[F1_READ_PLAN_MAX_RANGES];
+    uint8_t rangeCount = 0;
+    uint16_t compactSize = 0;     // Sum of all range lengths
+    int datagramSize = 0;         // Size of the datagram on the wire
+    uint8_t packetId = 0;         // m_packetId, for keeping the newest of each type
+};
+
+// Pointers into either a full datagram or a compact buffer
+struct F1PacketView {
+    const uint8_t* header;
+    const uint8_t* body;          // First byte after the header
+    const uint8_t* playerCar;     // Player car's entry in the per-car array
+    const uint8_t* cars;          // First per-car entry, nullptr if only the player's was copied
+    const uint8_t* trailer;       // Player-only data after the per-car array
+};
+
 class F1TelemetryParser {
 public:
     F1TelemetryParser();
@@ -77,15 +412,106 @@ public:
     F1TelemetryData getLatestData() const;
     bool isDataValid() const;
     
+    // Header-peek receive path: planRead() decides from the first
+    // F1_HEADER_PEEK_SIZE bytes whether a datagram is wanted and which byte
+    // ranges to copy, parseCompactPacket() decodes the buffer assembled from them.
+    // planRead() only reads the format tables and the wanted-packet mask, so the
+    // receive callback can call it.
+    bool planRead(const uint8_t* header, int datagramSize, F1ReadPlan& plan) const;
+    
+    // True if the first F1_HEADER_PEEK_SIZE bytes are a packet of a supported
+    // format, whether or not the pages want it. Game selection counts these.
+    static bool checkHeader(const uint8_t* header, int datagramSize);
+    bool parseCompactPacket(const uint8_t* buffer, int size);
+    
+    // parseCompactPacket() in two steps, for coalescing receive paths:
+    // admitCompactPacket() checks the buffer and runs it through frame
+    // sequencing (false = stale, duplicate or malformed), decodeCompactPacket()
+    // later decodes a buffer that was admitted
+    bool admitCompactPacket(const uint8_t* buffer, int size);
+    void decodeCompactPacket(const uint8_t* buffer);
+    
+    // Bitmask of (1 << packetId) the active pages need; others are dropped on the header
+    void setWantedPackets(uint16_t mask);
+    uint16_t getWantedPackets() const;
+    
+    F1SequenceStats getSequenceStats() const;
+    
+    #if F1_FIELD_TABLE
+    const F1FieldTable& getFieldTable() const;
+    #endif
+    
+    // Short display name for a packet ID ("LapData", "CarStatus", ...)
+    static const char* packetName(uint8_t packetId);
+    
 private:
+    // One entry per packet ID; decode == nullptr means the packet type is not used.
+    // prefixSize/carStride/trailerSize describe the bytes the decoder reads.
+    typedef void (F1TelemetryParser::*PacketDecoder)(const F1PacketView& view);
+    struct PacketHandler {
+        PacketDecoder decode;
+        uint16_t minSize;         // Full packet size on the wire
+        uint8_t prefixSize;       // Body bytes before the per-car array the decoder needs
+        uint8_t carStride;        // Size of one per-car entry (0 = no per-car data needed)
+        uint8_t trailerSize;      // Bytes after the per-car array the decoder needs
+        bool allCars;             // Decoder reads every car's entry, not just the player's
+    };
+    
+    // Handler table instantiated from F1Layout<Format>
+    template<uint16_t Format>
+    struct HandlerTable {
+        static const PacketHandler handlers[F1_PACKET_ID_COUNT];
+    };
+    
+    // Everything needed to classify a packet of one format
+    struct FormatInfo {
+        uint16_t format;
+        uint8_t headerSize;
+        uint8_t packetIdOffset;
+        uint8_t sessionUIDOffset;
+        uint8_t sequenceFrameOffset;
+        uint8_t playerCarIndexOffset;
+        uint8_t maxCars;
+        uint16_t packetMask;      // Packet IDs that exist in this format
+        const PacketHandler* handlers;
+    };
+    static const FormatInfo formats[F1_FORMAT_COUNT];
+    static const char* const packetNames[F1_PACKET_ID_COUNT];
+    
     F1TelemetryData latestData;
     unsigned long lastUpdateTime;
+    // Packet IDs the active pages want. Written by the render side, read by
+    // the receive callback and the telemetry task (other core on ESP32).
+    std::atomic<uint16_t> activePackets;
+    
+    // Last decoded frame per packet type
+    struct SequenceState {
+        uint32_t lastFrame;
+        uint16_t interval;        // Smallest frame step seen, 0 until learned
+        bool seen;
+    };
+    SequenceState sequence[F1_PACKET_ID_COUNT];
+    uint64_t sessionUID;
+    bool haveSession;
+    F1SequenceStats sequenceStats;
+    
+    #if F1_FIELD_TABLE
+    F1FieldTable fieldTable;
+    #endif
+    
+    static const FormatInfo* findFormat(const uint8_t* header);
+    bool acceptsPacket(const FormatInfo* format, uint8_t packetId) const;
+    static uint16_t compactCarBytes(const FormatInfo* format, const PacketHandler& handler);
+    static bool validateHeader(const FormatInfo* format, const uint8_t* header);
+    bool checkSequence(const FormatInfo* format, const uint8_t* header, uint8_t packetId);
+    void resetSequence();
+    void decodePacket(const FormatInfo* format, const F1PacketView& view);
     
-    bool validateHeader(const PacketHeader* header);
-    void parseCarTelemetry(const PacketCarTelemetryData* packet);
-    uint16_t readUint16LE(const uint8_t* data);
-    uint32_t readUint32LE(const uint8_t* data);
-    float readFloatLE(const uint8_t* data);
+    // Packet decoders - each writes only the fields the dashboard uses
+    template<uint16_t Format> void parseLapData(const F1PacketView& view);
+    template<uint16_t Format> void parseEvent(const F1PacketView& view);
+    template<uint16_t Format> void parseCarTelemetry(const F1PacketView& view);
+    template<uint16_t Format> void parseCarStatus(const F1PacketView& view);
 };
 
 #endif // TELEMETRY_F1_H
\ No newline at end of file
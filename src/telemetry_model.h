@@ -0,0 +1,64 @@
+#ifndef TELEMETRY_MODEL_H
+#define TELEMETRY_MODEL_H
+
+#include <Arduino.h>
+
+// The last packet decoded, for the debug page. The F1 entries run in
+// m_packetId order: PACKET_F1_MOTION + m_packetId.
+enum TelemetryPacketType : uint8_t {
+    PACKET_NONE,
+    PACKET_F1_MOTION,
+    PACKET_F1_SESSION,
+    PACKET_F1_LAP_DATA,
+    PACKET_F1_EVENT,
+    PACKET_F1_PARTICIPANTS,
+    PACKET_F1_CAR_SETUPS,
+    PACKET_F1_CAR_TELEMETRY,
+    PACKET_F1_CAR_STATUS,
+    PACKET_F1_FINAL_CLASSIFICATION,
+    PACKET_F1_LOBBY_INFO,
+    PACKET_PCARS_UDP,             // The game's own packets
+    PACKET_PCARS_FORWARDER,       // pcars_forwarder.py binary frame
+    PACKET_PCARS_JSON,            // pcars_forwarder.py JSON
+    PACKET_TYPE_COUNT
+};
+
+inline const char* packetTypeName(TelemetryPacketType type) {
+    static const char* const names[PACKET_TYPE_COUNT] = {
+        "None",
+        "F1 Motion", "F1 Session", "F1 LapData", "F1 Event", "F1 Participants",
+        "F1 CarSetups", "F1 CarTelemetry", "F1 CarStatus", "F1 FinalClass", "F1 LobbyInfo",
+        "PCARS UDP", "PCARS FWD", "PCARS JSON",
+    };
+    return type < PACKET_TYPE_COUNT ? names[type] : "Unknown";
+}
+
+// What the dashboard shows: filled from the parsers in main.cpp, drawn by the
+// display managers. The one definition every translation unit shares. Plain
+// values only, so copying it (ESP32 snapshots) never touches the heap.
+struct TelemetryData {
+    float speed = 0.0f;
+    int gear = 0;
+    int rpm = 0;
+    int maxRPM = 0;                 // Rev limiter from car status, 0 until the game reports it
+    bool shiftCue = false;          // Time to shift, ahead of the latency (see ShiftLight)
+    float fuel = 0.0f;
+    float lapTime = 0.0f;
+    int position = 0;
+    bool dataValid = false;
+    bool stale = false;             // WiFi is down; values are the last ones received
+    unsigned long lastUpdate = 0;
+    uint32_t receivedMicros = 0;    // micros() when the newest datagram arrived
+    TelemetryPacketType lastPacketType = PACKET_NONE;
+    int lastPacketSize = 0;
+    uint32_t sourceIP = 0;          // IPv4 as IPAddress stores it: first octet in the low byte
+    uint32_t framesLost = 0;        // F1 frame sequencing counters
+    uint32_t framesReordered = 0;
+    uint32_t framesDuplicated = 0;
+    uint32_t framesCoalesced = 0;   // Replaced by a newer packet of the same type before decoding
+    uint32_t packetsDropped = 0;    // Receive ring overflows
+    uint32_t sendersRejected = 0;   // Datagrams from rigs other than the pinned one
+    bool gameManual = false;        // Game pinned with SELECT rather than auto-selected
+};
+
+#endif // TELEMETRY_MODEL_H
@@ -1,14 +1,51 @@
 #include "telemetry_pcars.h"
 
-PCARSTelemetryParser::PCARSTelemetryParser() : lastUpdateTime(0) {
+static_assert(PCARS2Layout::kTimingsParticipants + PCARS2_MAX_PARTICIPANTS * PCARS2Layout::kTimingsStride <=
+              PCARS2Layout::TimingsLocalParticipant::kOffset, "timings participants overlap trailer");
+static_assert(PCARS2Layout::kStatsParticipants + PCARS2_MAX_PARTICIPANTS * PCARS2Layout::kStatsStride <=
+              PCARS2Layout::kTimeStatsSize, "time stats participants past packet end");
+static_assert(PCARS_MAX_PACKET_SIZE >= PCARS2Layout::kTimingsSize &&
+              PCARS_MAX_PACKET_SIZE >= PCARS2Layout::kTimeStatsSize &&
+              PCARS_MAX_PACKET_SIZE >= PCARS2Layout::kTelemetrySize &&
+              PCARS_MAX_PACKET_SIZE >= PCARSForwarderLayout::kSize, "PCARS receive slot too small");
+static_assert(fieldFits<PCARS2Layout::TimingCurrentTime>(PCARS2Layout::kTimingsStride), "timing field outside entry");
+
+PCARSTelemetryParser::PCARSTelemetryParser() : lastUpdateTime(0), seenPackets(0), participantIndex(-1),
+                                               lastForwarderSequence(0), lastForwarderTimestamp(0),
+                                               haveForwarderFrame(false) {
 }
 
 void PCARSTelemetryParser::begin() {
     Serial.println("PCARS Telemetry Parser initialized");
     latestData = PCARSTelemetryData(); // Reset to defaults
+    seenPackets = 0;
+    participantIndex = -1;
+    haveForwarderFrame = false;
+    
+    // Only these keys are kept when parsing forwarder JSON
+    jsonFilter.clear();
+    jsonFilter["speed"] = true;
+    jsonFilter["gear"] = true;
+    jsonFilter["rpm"] = true;
+    jsonFilter["fuel"] = true;
+    jsonFilter["lapTime"] = true;
 }
 
-bool PCARSTelemetryParser::parsePacket(const uint8_t* buffer, int size) {
+// Decoder dispatch table indexed by mPacketType. Participant and vehicle
+// name packets carry nothing the dashboard shows.
+const PCARSTelemetryParser::PacketHandler PCARSTelemetryParser::handlers[PCARS2_PACKET_TYPE_COUNT] = {
+    { &PCARSTelemetryParser::parseTelemetry, PCARS2Layout::kTelemetrySize },
+    { &PCARSTelemetryParser::parseRaceDefinition, PCARS2Layout::kRaceDefinitionSize },
+    { nullptr, 0 },  // Participants
+    { &PCARSTelemetryParser::parseTimings, PCARS2Layout::kTimingsSize },
+    { &PCARSTelemetryParser::parseGameState, PCARS2Layout::kGameStateSize },
+    { nullptr, 0 },  // Weather state (not sent)
+    { nullptr, 0 },  // Vehicle names (not sent)
+    { &PCARSTelemetryParser::parseTimeStats, PCARS2Layout::kTimeStatsSize },
+    { nullptr, 0 },  // Participant vehicle names
+};
+
+bool PCARSTelemetryParser::parsePacket(const uint8_t* buffer, int size, uint8_t source) {
     if (size < 4) {
         #if DEBUG_UDP
         Serial.printf("PCARS: Packet too small (%d bytes)\n", size);
@@ -16,30 +53,102 @@ bool PCARSTelemetryParser::parsePacket(const uint8_t* buffer, int size) {
         return false;
     }
     
-    // Check if this looks like a JSON packet (forwarder data)
-    if (isJSONPacket(buffer, size)) {
+    // The listener says what the datagram is - no content sniffing needed
+    if (source == UDP_SOURCE_PCARS_FORWARDER) {
+        // Binary frames have a fixed size and magic, anything else is JSON
+        if (isForwarderFrame(buffer, size)) {
+            return parseForwarderFrame(buffer);
+        }
         return parseJSONForwarder(buffer, size);
-    } else {
-        return parseBinaryUDP(buffer, size);
-    }
-}
-
-bool PCARSTelemetryParser::isJSONPacket(const uint8_t* buffer, int size) {
-    // Simple heuristic: JSON packets start with '{' and are printable
-    if (size > 0 && buffer[0] == '{') {
-        // Check if the packet contains mostly printable characters
-        int printableCount = 0;
-        int checkSize = min(size, 50); // Check first 50 bytes
-        
-        for (int i = 0; i < checkSize; i++) {
-            if (isprint(buffer[i]) || buffer[i] == '\n' || buffer[i] == '\r') {
-                printableCount++;
-            }
+    }
+    return parseBinaryUDP(buffer, size);
+}
+
+bool PCARSTelemetryParser::checkHeader(const uint8_t* header, int size, uint8_t source) {
+    if (size < 4) {
+        return false;
+    }
+    if (source == UDP_SOURCE_PCARS_FORWARDER) {
+        return isForwarderFrame(header, size) || header[0] == '{';
+    }
+    if (size < PCARS2_PACKET_BASE_SIZE || size > PCARS_MAX_PACKET_SIZE) {
+        return false;
+    }
+    
+    uint8_t packetType = PCARS2Layout::PacketType::get(header);
+    return packetType < PCARS2_PACKET_TYPE_COUNT && handlers[packetType].decode != nullptr &&
+           size >= handlers[packetType].minSize;
+}
+
+bool PCARSTelemetryParser::isForwarderFrame(const uint8_t* buffer, int size) {
+    return size == PCARSForwarderLayout::kSize &&
+           PCARSForwarderLayout::Magic::get(buffer) == PCARS_FORWARDER_MAGIC;
+}
+
+// CRC16-CCITT, poly 0x1021, init 0xFFFF (Python: binascii.crc_hqx(data, 0xFFFF))
+static uint16_t crc16CCITT(const uint8_t* data, int length) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
         }
-        
-        return (printableCount > checkSize * 0.8); // 80% printable = likely JSON
     }
-    return false;
+    return crc;
+}
+
+bool PCARSTelemetryParser::parseForwarderFrame(const uint8_t* buffer) {
+    typedef PCARSForwarderLayout L;
+    
+    if (L::Version::get(buffer) != PCARS_FORWARDER_VERSION) {
+        #if DEBUG_UDP
+        Serial.printf("PCARS Frame: Unsupported version %d\n", L::Version::get(buffer));
+        #endif
+        return false;
+    }
+    
+    if (crc16CCITT(buffer, L::Crc::kOffset) != L::Crc::get(buffer)) {
+        #if DEBUG_UDP
+        Serial.println("PCARS Frame: CRC mismatch");
+        #endif
+        return false;
+    }
+    
+    // Stale only if both the sequence and the sender clock went backwards, so
+    // a restarted forwarder (sequence back to 0, clock still moving) gets through
+    uint16_t sequence = L::Sequence::get(buffer);
+    uint32_t timestamp = L::Timestamp::get(buffer);
+    if (haveForwarderFrame &&
+        static_cast<int16_t>(sequence - lastForwarderSequence) <= 0 &&
+        static_cast<int32_t>(timestamp - lastForwarderTimestamp) <= 0) {
+        #if DEBUG_UDP
+        Serial.printf("PCARS Frame: Dropped stale frame %u\n", sequence);
+        #endif
+        return false;
+    }
+    haveForwarderFrame = true;
+    lastForwarderSequence = sequence;
+    lastForwarderTimestamp = timestamp;
+    
+    latestData.speed = L::Speed::get(buffer);
+    latestData.gear = L::Gear::get(buffer);
+    latestData.rpm = L::Rpm::get(buffer);
+    latestData.engineSamples++;
+    latestData.fuel = L::Fuel::get(buffer);
+    latestData.lapTime = L::LapTime::get(buffer);
+    
+    latestData.isForwarderData = true;
+    latestData.isForwarderFrame = true;
+    latestData.dataValid = true;
+    latestData.timestamp = millis();
+    lastUpdateTime = latestData.timestamp;
+    
+    #if DEBUG_UDP
+    Serial.printf("PCARS Frame Parsed: Seq=%u, Speed=%.1f, Gear=%d, RPM=%d\n",
+                 sequence, latestData.speed, latestData.gear, latestData.rpm);
+    #endif
+    
+    return true;
 }
 
 bool PCARSTelemetryParser::parseJSONForwarder(const uint8_t* buffer, int size) {
@@ -49,29 +158,17 @@ bool PCARSTelemetryParser::parseJSONForwarder(const uint8_t* buffer, int size) {
     #ifdef ESP8266_BOARD
     // ESP8266 memory optimization
     yield();
-    
-    // Limit buffer size for ESP8266 memory constraints
-    if (size > 512) {
-        size = 512;
-    }
     #endif
     
-    // Null-terminate the buffer for JSON parsing
-    char jsonBuffer[size + 1];
-    memcpy(jsonBuffer, buffer, size);
-    jsonBuffer[size] = '\0';
-    
     #if DEBUG_UDP
-    Serial.printf("PCARS JSON: %s\n", jsonBuffer);
+    Serial.printf("PCARS JSON: %.*s\n", size, reinterpret_cast<const char*>(buffer));
     #endif
     
-    // Parse JSON - adjust buffer size based on platform
-    #ifdef ESP8266_BOARD
-    DynamicJsonDocument doc(256);  // Smaller buffer for ESP8266
-    #else
-    DynamicJsonDocument doc(512);  // Larger buffer for ESP32
-    #endif
-    DeserializationError error = deserializeJson(doc, jsonBuffer);
+    // Parse straight from the receive buffer into the reused document. The
+    // filter drops every key but the five below, so the document never grows
+    // past them and nothing is allocated.
+    DeserializationError error = deserializeJson(jsonDoc, reinterpret_cast<const char*>(buffer), size,
+                                                 DeserializationOption::Filter(jsonFilter));
     
     if (error) {
         #if DEBUG_UDP
@@ -80,28 +177,18 @@ bool PCARSTelemetryParser::parseJSONForwarder(const uint8_t* buffer, int size) {
         return false;
     }
     
-    // Extract telemetry data
-    if (doc.containsKey("speed")) {
-        latestData.speed = doc["speed"].as<float>();
-    }
-    
-    if (doc.containsKey("gear")) {
-        latestData.gear = doc["gear"].as<int>();
-    }
-    
-    if (doc.containsKey("rpm")) {
-        latestData.rpm = doc["rpm"].as<int>();
-    }
-    
-    if (doc.containsKey("fuel")) {
-        latestData.fuel = doc["fuel"].as<float>();
-    }
-    
-    if (doc.containsKey("lapTime")) {
-        latestData.lapTime = doc["lapTime"].as<float>();
+    // Extract telemetry data, keeping the previous value for missing keys
+    latestData.speed = jsonDoc["speed"] | latestData.speed;
+    latestData.gear = jsonDoc["gear"] | latestData.gear;
+    if (!jsonDoc["rpm"].isNull()) {
+        latestData.rpm = jsonDoc["rpm"] | latestData.rpm;
+        latestData.engineSamples++;
     }
+    latestData.fuel = jsonDoc["fuel"] | latestData.fuel;
+    latestData.lapTime = jsonDoc["lapTime"] | latestData.lapTime;
     
     latestData.isForwarderData = true;
+    latestData.isForwarderFrame = false;
     latestData.dataValid = true;
     latestData.timestamp = millis();
     lastUpdateTime = latestData.timestamp;
@@ -115,79 +202,137 @@ bool PCARSTelemetryParser::parseJSONForwarder(const uint8_t* buffer, int size) {
 }
 
 bool PCARSTelemetryParser::parseBinaryUDP(const uint8_t* buffer, int size) {
-    // Parse binary PCARS2 UDP data
-    // Note: This is a simplified implementation. PCARS2 has a complex binary format
-    // that varies between different packet types and game versions.
+    if (size < PCARS2_PACKET_BASE_SIZE) {
+        #if DEBUG_UDP
+        Serial.printf("PCARS Binary: Packet too small (%d bytes)\n", size);
+        #endif
+        return false;
+    }
     
-    // TODO: Implement full PCARS2 binary parsing
-    // For now, this is a placeholder that attempts basic parsing
+    uint8_t packetType = PCARS2Layout::PacketType::get(buffer);
+    if (packetType >= PCARS2_PACKET_TYPE_COUNT || handlers[packetType].decode == nullptr) {
+        return false;
+    }
     
-    if (size < 100) { // PCARS packets are typically much larger
+    const PacketHandler& handler = handlers[packetType];
+    if (size < handler.minSize) {
         #if DEBUG_UDP
-        Serial.printf("PCARS Binary: Packet too small for PCARS2 (%d bytes)\n", size);
+        Serial.printf("PCARS Binary: Type %d too small (%d < %d)\n", packetType, size, handler.minSize);
         #endif
         return false;
     }
     
-    // Attempt to identify PCARS2 packet by looking for known patterns
-    // This is a very basic implementation and may not work with all PCARS2 versions
+    if (!checkSequence(packetType, PCARS2Layout::PacketNumber::get(buffer))) {
+        return false;
+    }
     
-    // Check for potential build version at start (common in PCARS packets)
-    uint32_t buildVersion = readUint32LE(buffer);
+    (this->*handler.decode)(buffer);
     
-    if (buildVersion > 1000 && buildVersion < 10000) { // Reasonable build number range
-        // Try to extract basic telemetry data from known approximate offsets
-        // WARNING: These offsets are estimates and may not be accurate
-        // for all PCARS2 versions. Use JSON forwarder for reliable data.
-        
-        // Check if we have enough data for basic parsing
-        if (size < 40) {
-            #if DEBUG_UDP
-            Serial.println("PCARS Binary: Packet too small for parsing");
-            #endif
-            return false;
-        }
-        
-        // These are rough estimates - actual offsets vary by packet type and version
-        float speedMS = readFloatLE(buffer + 16);  // Speed in m/s (estimated offset)
-        float rpm = readFloatLE(buffer + 24);      // RPM (estimated offset)
-        int8_t gear = static_cast<int8_t>(buffer[32]); // Gear (estimated offset)
-        
-        // Sanity checks for reasonable values
-        if (speedMS < 0 || speedMS > 200 || rpm < 0 || rpm > 20000 || gear < -1 || gear > 8) {
+    latestData.isForwarderData = false;
+    latestData.isForwarderFrame = false;
+    latestData.dataValid = true;
+    latestData.timestamp = millis();
+    lastUpdateTime = latestData.timestamp;
+    
+    return true;
+}
+
+bool PCARSTelemetryParser::checkSequence(uint8_t packetType, uint32_t packetNumber) {
+    // mPacketNumber counts every packet the game sends, so within one type it
+    // only goes up. Anything not newer than the last accepted packet is a
+    // duplicate or arrived late, unless it is so far back the game restarted.
+    uint16_t bit = 1u << packetType;
+    if (seenPackets & bit) {
+        int32_t delta = static_cast<int32_t>(packetNumber - lastPacketNumber[packetType]);
+        if (delta <= 0 && delta >= -PCARS_SEQUENCE_REWIND_PACKETS) {
             #if DEBUG_UDP
-            Serial.println("PCARS Binary: Invalid data values");
+            Serial.printf("PCARS Binary: Dropped stale type %d packet %u\n", packetType, packetNumber);
             #endif
             return false;
         }
-        
-        // Convert speed from m/s to km/h
-        latestData.speed = speedMS * 3.6f;
-        latestData.rpm = static_cast<int>(rpm);
-        latestData.gear = static_cast<int>(gear);
-        
-        // Set defaults for data not easily extractable
-        latestData.fuel = 50.0f; // Default fuel level
-        latestData.lapTime = 0.0f; // Default lap time
-        
-        latestData.isForwarderData = false;
-        latestData.dataValid = true;
-        latestData.timestamp = millis();
-        lastUpdateTime = latestData.timestamp;
-        
-        #if DEBUG_UDP
-        Serial.printf("PCARS Binary Parsed: Speed=%.1f, Gear=%d, RPM=%d\n",
-                     latestData.speed, latestData.gear, latestData.rpm);
-        #endif
-        
-        return true;
     }
     
+    seenPackets |= bit;
+    lastPacketNumber[packetType] = packetNumber;
+    return true;
+}
+
+void PCARSTelemetryParser::parseTelemetry(const uint8_t* packet) {
+    typedef PCARS2Layout L;
+    
+    int8_t viewed = L::TelemetryViewedParticipant::get(packet);
+    if (viewed >= 0 && viewed < PCARS2_MAX_PARTICIPANTS) {
+        participantIndex = viewed;
+    }
+    
+    // Gear 0 = neutral, 15 = reverse
+    uint8_t gear = L::TelemetryGearNumGears::get(packet) & 0x0F;
+    
+    latestData.speed = L::TelemetrySpeed::get(packet) * 3.6f;
+    latestData.gear = (gear == 15) ? -1 : gear;
+    latestData.rpm = L::TelemetryRpm::get(packet);
+    latestData.maxRpm = L::TelemetryMaxRpm::get(packet);
+    latestData.engineSamples++;
+    latestData.fuel = L::TelemetryFuelLevel::get(packet) * 100.0f;
+    latestData.fuelCapacity = L::TelemetryFuelCapacity::get(packet);
+    
     #if DEBUG_UDP
-    Serial.printf("PCARS Binary: Unrecognized packet format (build: %u)\n", buildVersion);
+    Serial.printf("PCARS Binary Parsed: Speed=%.1f, Gear=%d, RPM=%d, Fuel=%.1f%%\n",
+                 latestData.speed, latestData.gear, latestData.rpm, latestData.fuel);
     #endif
+}
+
+void PCARSTelemetryParser::parseRaceDefinition(const uint8_t* packet) {
+    typedef PCARS2Layout L;
+    
+    // Timed sessions set the top bit and count 5 minute units instead of laps
+    uint16_t lapsTime = L::RaceLapsTimeInEvent::get(packet);
+    latestData.totalLaps = (lapsTime & 0x8000) ? 0 : lapsTime;
+}
+
+void PCARSTelemetryParser::parseTimings(const uint8_t* packet) {
+    typedef PCARS2Layout L;
+    
+    // Until a telemetry packet says which car is viewed, follow the local player
+    uint16_t local = L::TimingsLocalParticipant::get(packet);
+    if (participantIndex < 0 && local < PCARS2_MAX_PARTICIPANTS) {
+        participantIndex = local;
+    }
+    if (participantIndex < 0 || participantIndex >= L::TimingsNumParticipants::get(packet)) {
+        return;
+    }
     
-    return false;
+    const uint8_t* entry = packet + L::kTimingsParticipants + participantIndex * L::kTimingsStride;
+    latestData.position = L::TimingRacePosition::get(entry) & 0x7F;
+    latestData.currentLap = L::TimingCurrentLap::get(entry);
+    latestData.currentLapTime = L::TimingCurrentTime::get(entry);
+}
+
+void PCARSTelemetryParser::parseGameState(const uint8_t* packet) {
+    typedef PCARS2Layout L;
+    
+    int gameState = L::GameState::get(packet) & 0x07;
+    
+    // Back in the menus or restarting - lap state from the last session is stale
+    if (gameState != latestData.gameState &&
+        (gameState == PCARS2_GAME_FRONT_END || gameState == PCARS2_GAME_INGAME_RESTARTING)) {
+        latestData.lapTime = 0.0f;
+        latestData.currentLapTime = 0.0f;
+        latestData.position = 0;
+        latestData.currentLap = 0;
+    }
+    latestData.gameState = gameState;
+}
+
+void PCARSTelemetryParser::parseTimeStats(const uint8_t* packet) {
+    typedef PCARS2Layout L;
+    
+    if (participantIndex < 0) {
+        return;
+    }
+    
+    const uint8_t* entry = packet + L::kStatsParticipants + participantIndex * L::kStatsStride;
+    latestData.lapTime = L::StatsLastLapTime::get(entry);
 }
 
 PCARSTelemetryData PCARSTelemetryParser::getLatestData() const {
@@ -198,17 +343,3 @@ bool PCARSTelemetryParser::isDataValid() const {
     // Data is valid if we received it recently (within 5 seconds)
     return latestData.dataValid && (millis() - lastUpdateTime < 5000);
 }
-
-// Helper functions for endian handling
-float PCARSTelemetryParser::readFloatLE(const uint8_t* data) {
-    union {
-        uint32_t i;
-        float f;
-    } converter;
-    converter.i = readUint32LE(data);
-    return converter.f;
-}
-
-uint32_t PCARSTelemetryParser::readUint32LE(const uint8_t* data) {
-    return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
-}
\ No newline at end of file
@@ -4,46 +4,129 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "config.h"
+#include "le_fields.h"
 
-// Project CARS 2 UDP Telemetry Structure
-// Note: PCARS2 has a complex binary format. This is a simplified version
-// focusing on the most important fields for dashboard display.
-// For complete specification, refer to community documentation.
+// Project CARS 2 UDP Telemetry (game setting "UDP Protocol Version: Project CARS 2").
+// Every packet starts with a 12-byte PacketBase and mPacketType selects the
+// layout. Offsets follow SMS_UDP_Definitions.hpp from the game's SDK.
+#define PCARS2_PACKET_BASE_SIZE 12
+#define PCARS2_MAX_PARTICIPANTS 32
 
-#pragma pack(push, 1)
+// Packet types (mPacketType)
+#define PCARS2_PACKET_TELEMETRY 0
+#define PCARS2_PACKET_RACE_DEFINITION 1
+#define PCARS2_PACKET_PARTICIPANTS 2
+#define PCARS2_PACKET_TIMINGS 3
+#define PCARS2_PACKET_GAME_STATE 4
+#define PCARS2_PACKET_TIME_STATS 7
+#define PCARS2_PACKET_PARTICIPANT_VEHICLE_NAMES 8
+#define PCARS2_PACKET_TYPE_COUNT 9
 
-// Simplified PCARS2 telemetry structure (partial implementation)
-// TODO: Complete implementation based on community reverse engineering
-// Reference: https://github.com/SHWotever/SimHub/wiki/Project-Cars-2
-struct PCARSUDPData {
-    // Header-like fields (first few bytes to identify packet type)
-    uint32_t buildVersionNumber;     // Build version
-    uint8_t  packetType;             // Packet type identifier
+// Game states (low 3 bits of mGameState)
+#define PCARS2_GAME_EXITED 0
+#define PCARS2_GAME_FRONT_END 1
+#define PCARS2_GAME_INGAME_PLAYING 2
+#define PCARS2_GAME_INGAME_PAUSED 3
+#define PCARS2_GAME_INGAME_INMENU_TIME_TICKING 4
+#define PCARS2_GAME_INGAME_RESTARTING 5
+#define PCARS2_GAME_INGAME_REPLAY 6
+#define PCARS2_GAME_FRONT_END_REPLAY 7
+
+// Binary forwarder frame (pcars_forwarder.py default). Fixed size, little-endian,
+// CRC16-CCITT (poly 0x1021, init 0xFFFF) over everything before the CRC.
+#define PCARS_FORWARDER_MAGIC 0x57464350     // "PCFW"
+#define PCARS_FORWARDER_VERSION 1
+
+struct PCARSForwarderLayout {
+    LE_FIELD(Magic, uint32_t, 0);
+    LE_FIELD(Version, uint8_t, 4);
+    LE_FIELD(Sequence, uint16_t, 6);           // +1 per frame, wraps
+    LE_FIELD(Timestamp, uint32_t, 8);          // Sender wall clock in ms, wraps
+    LE_FIELD(Speed, float, 12);                // km/h
+    LE_FIELD(Rpm, uint16_t, 16);
+    LE_FIELD(Gear, int8_t, 18);                // -1 = R, 0 = N
+    LE_FIELD(Fuel, float, 20);                 // Percent
+    LE_FIELD(LapTime, float, 24);              // Last lap, seconds
+    LE_FIELD(Crc, uint16_t, 28);
+    
+    enum : uint16_t {
+        kSize = Crc::kEnd
+    };
+};
+
+// Forwarder JSON documents: the five keys plus copies of their names
+#define PCARS_JSON_KEY_COUNT 5
+#define PCARS_JSON_DOC_SIZE (JSON_OBJECT_SIZE(PCARS_JSON_KEY_COUNT) + 32)
+#define PCARS_JSON_FILTER_SIZE JSON_OBJECT_SIZE(PCARS_JSON_KEY_COUNT)
+
+struct PCARS2Layout {
+    // PacketBase
+    LE_FIELD(PacketNumber, uint32_t, 0);           // Counts every packet sent this game run
+    LE_FIELD(PacketType, uint8_t, 10);
+    
+    // sTelemetryData (car physics)
+    LE_FIELD(TelemetryViewedParticipant, int8_t, 12);  // -1 = none
+    LE_FIELD(TelemetryFuelCapacity, uint8_t, 28);  // Litres
+    LE_FIELD(TelemetryFuelLevel, float, 32);       // 0.0-1.0
+    LE_FIELD(TelemetrySpeed, float, 36);           // m/s
+    LE_FIELD(TelemetryRpm, uint16_t, 40);
+    LE_FIELD(TelemetryMaxRpm, uint16_t, 42);
+    LE_FIELD(TelemetryGearNumGears, uint8_t, 45);  // Low nibble gear (0 = N, 15 = R), high nibble gear count
+    
+    // sRaceData (race definition)
+    LE_FIELD(RaceLapsTimeInEvent, uint16_t, 304);  // Lap count, or top bit set for timed sessions
+    
+    // sTimingsData, then sParticipantInfo relative to one participant's entry
+    LE_FIELD(TimingsNumParticipants, int8_t, 12);
+    LE_FIELD(TimingsLocalParticipant, uint16_t, 1057);
+    LE_FIELD(TimingRacePosition, uint8_t, 14);     // Top bit = participant active
+    LE_FIELD(TimingCurrentLap, uint8_t, 21);
+    LE_FIELD(TimingCurrentTime, float, 22);        // Seconds into the current lap
     
-    // Essential telemetry data (approximate offsets)
-    float speed;                     // Speed in m/s
-    float engineRPM;                 // Engine RPM
-    float maxRPM;                    // Maximum RPM
-    int8_t gear;                     // Current gear (-1=R, 0=N, 1-8=gears)
-    float fuelLevel;                 // Fuel level (0.0-1.0)
-    float lastLapTime;               // Last lap time in seconds
+    // sGameStateData
+    LE_FIELD(GameState, uint8_t, 14);              // Low 3 bits game state, next 3 session state
     
-    // Note: This is a simplified structure. PCARS2 packets are much larger
-    // and contain many more fields. For production use, implement full parsing
-    // or use the JSON forwarder approach.
+    // sTimeStatsData, sParticipantStatsInfo relative to one participant's entry
+    LE_FIELD(StatsLastLapTime, float, 4);          // Seconds
+    
+    enum : uint16_t {
+        kTelemetrySize = 559,
+        kRaceDefinitionSize = 308,
+        kTimingsSize = 1063,
+        kGameStateSize = 24,
+        kTimeStatsSize = 1040,
+        
+        kTimingsParticipants = 33,     // Offset of sParticipants[]
+        kTimingsStride = 32,
+        kStatsParticipants = 16,       // Offset of sStats.sParticipants[]
+        kStatsStride = 32,
+    };
 };
 
-#pragma pack(pop)
+// Largest packet any handler decodes (timings); bigger datagrams are dropped on receive
+#define PCARS_MAX_PACKET_SIZE 1063
+
+// Bytes checkHeader() looks at: the packet base, or a forwarder frame's magic
+#define PCARS_HEADER_PEEK_SIZE PCARS2_PACKET_BASE_SIZE
 
 // Simplified telemetry data for display
 struct PCARSTelemetryData {
     float speed = 0.0f;           // km/h (converted from m/s)
     int gear = 0;                 // Current gear
     int rpm = 0;                  // Engine RPM
+    int maxRpm = 0;               // Rev limiter RPM (telemetry packet)
+    uint32_t engineSamples = 0;   // Packets that carried the RPM, so a new reading shows as a change
     float fuel = 0.0f;            // Fuel level percentage
+    int fuelCapacity = 0;         // Tank capacity in litres (telemetry packet)
     float lapTime = 0.0f;         // Last lap time
+    float currentLapTime = 0.0f;  // Time into the current lap (timings packet)
+    int position = 0;             // Race position, 0 = unknown (timings packet)
+    int currentLap = 0;           // Current lap number (timings packet)
+    int totalLaps = 0;            // Race distance in laps, 0 for timed sessions (race definition packet)
+    int gameState = PCARS2_GAME_EXITED; // PCARS2_GAME_* (game state packet)
     bool dataValid = false;       // Data validity flag
-    bool isForwarderData = false; // True if data came from JSON forwarder
+    bool isForwarderData = false; // True if data came from the forwarder
+    bool isForwarderFrame = false; // Forwarder data came as a binary frame rather than JSON
     unsigned long timestamp = 0;  // When data was received
 };
 
@@ -51,19 +134,53 @@ class PCARSTelemetryParser {
 public:
     PCARSTelemetryParser();
     void begin();
-    bool parsePacket(const uint8_t* buffer, int size);
+    // source is the listener the datagram arrived on: UDP_SOURCE_PCARS for the
+    // game's packets, UDP_SOURCE_PCARS_FORWARDER for forwarder frames or JSON
+    bool parsePacket(const uint8_t* buffer, int size, uint8_t source);
+    
+    // Cheap plausibility check on the first PCARS_HEADER_PEEK_SIZE bytes of a
+    // datagram of size bytes, no decoding. Game selection counts these.
+    static bool checkHeader(const uint8_t* header, int size, uint8_t source);
     PCARSTelemetryData getLatestData() const;
     bool isDataValid() const;
     
 private:
+    // One entry per mPacketType; decode == nullptr means the type is not used
+    typedef void (PCARSTelemetryParser::*PacketDecoder)(const uint8_t* packet);
+    struct PacketHandler {
+        PacketDecoder decode;
+        uint16_t minSize;
+    };
+    static const PacketHandler handlers[PCARS2_PACKET_TYPE_COUNT];
+    
     PCARSTelemetryData latestData;
     unsigned long lastUpdateTime;
     
+    // Ordering on mPacketNumber, per packet type
+    uint32_t lastPacketNumber[PCARS2_PACKET_TYPE_COUNT];
+    uint16_t seenPackets;         // Bit per packet type with a valid lastPacketNumber
+    int participantIndex;         // Viewed car's entry in the timings and stats arrays, -1 = unknown
+    
+    // Reused for every forwarder packet, so JSON parsing never touches the heap
+    StaticJsonDocument<PCARS_JSON_DOC_SIZE> jsonDoc;
+    StaticJsonDocument<PCARS_JSON_FILTER_SIZE> jsonFilter;
+    
+    // Last accepted forwarder frame, for dropping stale and duplicate frames.
+    uint16_t lastForwarderSequence;
+    uint32_t lastForwarderTimestamp;
+    bool haveForwarderFrame;
+    
+    bool parseForwarderFrame(const uint8_t* buffer);
+    static bool isForwarderFrame(const uint8_t* buffer, int size);
     bool parseJSONForwarder(const uint8_t* buffer, int size);
     bool parseBinaryUDP(const uint8_t* buffer, int size);
-    bool isJSONPacket(const uint8_t* buffer, int size);
-    float readFloatLE(const uint8_t* data);
-    uint32_t readUint32LE(const uint8_t* data);
+    bool checkSequence(uint8_t packetType, uint32_t packetNumber);
+    
+    void parseTelemetry(const uint8_t* packet);
+    void parseRaceDefinition(const uint8_t* packet);
+    void parseTimings(const uint8_t* packet);
+    void parseGameState(const uint8_t* packet);
+    void parseTimeStats(const uint8_t* packet);
 };
 
 #endif // TELEMETRY_PCARS_H
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "telemetry_receiver.h"
+
+static_assert(PACKET_F1_LOBBY_INFO - PACKET_F1_MOTION == F1_PACKET_ID_LOBBY_INFO,
+              "TelemetryPacketType F1 entries must follow m_packetId");
+
+TelemetryReceiver::TelemetryReceiver(NetworkManager& network, F1Receiver& f1Receiver, F1TelemetryParser& f1Parser,
+                                     PCARSTelemetryParser& pcarsParser, ShiftLight& shiftLight) :
+    network(network),
+    f1Receiver(f1Receiver),
+    f1Parser(f1Parser),
+    pcarsParser(pcarsParser),
+    shiftLight(shiftLight),
+    lastGame(-1) {
+    for (int i = 0; i < GAME_COUNT; i++) {
+        lastEngineSamples[i] = 0;
+    }
+}
+
+bool TelemetryReceiver::receive(int game, TelemetryData& data, unsigned long currentTime) {
+    // The receive callback queued every datagram as it arrived; drain the
+    // queues so the display always shows the newest data
+    if (game != lastGame) {
+        lastGame = game;
+        data.shiftCue = false;
+        shiftLight.reset();
+    }
+
+    bool dataUpdated = false;
+    if (game == GAME_F1) {
+        dataUpdated = receiveF1(data, currentTime);
+    } else if (game == GAME_PCARS) {
+        dataUpdated = receivePCARS(data, currentTime);
+    }
+
+    data.packetsDropped = network.getDroppedCount();
+    data.sendersRejected = network.getRejectedSenderCount();
+
+    // Check for data timeout (2 seconds for more stability). While the link
+    // is down the last values stay up, marked stale, rather than "NO DATA".
+    if (currentTime - data.lastUpdate > 2000) {
+        data.dataValid = false;
+        data.shiftCue = false;
+        shiftLight.reset();
+    }
+    data.stale = !data.dataValid && data.lastUpdate != 0 && !network.isConnected();
+
+    return dataUpdated;
+}
+
+bool TelemetryReceiver::receiveF1(TelemetryData& data, unsigned long currentTime) {
+    // Only the newest packet of each type is decoded
+    bool decoded = f1Receiver.receive();
+    if (decoded) {
+        F1TelemetryData f1Data = f1Parser.getLatestData();
+
+        data.speed = f1Data.speed;
+        data.gear = f1Data.gear;
+        data.rpm = f1Data.engineRPM;
+        data.maxRPM = f1Data.maxRPM;
+        // Dashboard shows fuel as a percentage of tank capacity
+        data.fuel = (f1Data.fuelCapacity > 0.0f) ?
+            (f1Data.fuelInTank * 100.0f / f1Data.fuelCapacity) : 0.0f;
+        data.lapTime = f1Data.lastLapTime;
+        data.position = f1Data.position;
+        data.dataValid = true;
+        data.lastUpdate = currentTime;
+        data.lastPacketType = static_cast<TelemetryPacketType>(PACKET_F1_MOTION + f1Data.lastPacketId);
+        data.lastPacketSize = f1Receiver.getLastDatagramSize();
+        data.sourceIP = (uint32_t)f1Receiver.getLastSourceIP();
+        data.receivedMicros = f1Receiver.getLastReceivedMicros();
+
+        // Only a new RPM reading moves the shift cue on
+        if (f1Data.engineSamples != lastEngineSamples[GAME_F1]) {
+            lastEngineSamples[GAME_F1] = f1Data.engineSamples;
+            data.shiftCue = shiftLight.addSample(f1Data.engineRPM, f1Data.gear, f1Data.maxRPM,
+                                                 f1Data.revLightsPercent, data.receivedMicros);
+        }
+
+        #if DEBUG_UDP
+        Serial.printf("F1 Data: Speed=%.1f, Gear=%d, RPM=%d\n",
+                     data.speed, data.gear, data.rpm);
+        #endif
+    }
+
+    // Dropped frames count too, so copy these whether or not anything decoded
+    F1SequenceStats seqStats = f1Parser.getSequenceStats();
+    data.framesLost = seqStats.lost;
+    data.framesReordered = seqStats.reordered;
+    data.framesDuplicated = seqStats.duplicates;
+    data.framesCoalesced = f1Receiver.getCoalescedCount();
+    return decoded;
+}
+
+// Each datagram updates the parser's state, from the game and the forwarder;
+// the dashboard copy is made once at the end
+bool TelemetryReceiver::receivePCARS(TelemetryData& data, unsigned long currentTime) {
+    static uint8_t buffer[PCARS_MAX_PACKET_SIZE];
+    bool updated = false;
+    UdpDatagram datagram;
+    for (uint8_t drained = 0; drained < UDP_DRAIN_LIMIT && network.readPCARSPacket(buffer, datagram); drained++) {
+        data.lastPacketSize = datagram.size;
+        data.sourceIP = (uint32_t)datagram.remoteIP;
+        data.receivedMicros = datagram.receivedMicros;
+        updated |= pcarsParser.parsePacket(buffer, datagram.size, datagram.tag);
+    }
+    if (!updated) {
+        return false;
+    }
+
+    PCARSTelemetryData pcarsData = pcarsParser.getLatestData();
+
+    data.speed = pcarsData.speed;
+    data.gear = pcarsData.gear;
+    data.rpm = pcarsData.rpm;
+    data.maxRPM = pcarsData.maxRpm;
+    data.fuel = pcarsData.fuel;
+    data.lapTime = pcarsData.lapTime;
+    data.position = pcarsData.position;
+    data.dataValid = true;
+    data.lastUpdate = currentTime;
+    if (pcarsData.isForwarderData) {
+        data.lastPacketType = pcarsData.isForwarderFrame ? PACKET_PCARS_FORWARDER : PACKET_PCARS_JSON;
+    } else {
+        data.lastPacketType = PACKET_PCARS_UDP;
+    }
+
+    if (pcarsData.engineSamples != lastEngineSamples[GAME_PCARS]) {
+        lastEngineSamples[GAME_PCARS] = pcarsData.engineSamples;
+        data.shiftCue = shiftLight.addSample(pcarsData.rpm, pcarsData.gear, pcarsData.maxRpm, 0,
+                                             data.receivedMicros);
+    }
+
+    #if DEBUG_UDP
+    Serial.printf("PCARS Data: Speed=%.1f, Gear=%d, RPM=%d\n",
+                 data.speed, data.gear, data.rpm);
+    #endif
+    return true;
+}
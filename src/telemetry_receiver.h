@@ -0,0 +1,39 @@
+#ifndef TELEMETRY_RECEIVER_H
+#define TELEMETRY_RECEIVER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "network_manager.h"
+#include "f1_receiver.h"
+#include "telemetry_f1.h"
+#include "telemetry_pcars.h"
+#include "shift_light.h"
+#include "telemetry_model.h"
+
+// Receive side of the dashboard: drains the selected game's receive queue
+// through its parser into the TelemetryData the pages draw, feeds the shift
+// cue and handles the data timeout. Runs once per loop on ESP8266, in the
+// telemetry task on ESP32. A game change starts the shift cue afresh: the
+// slope it learnt belongs to the other game's car.
+class TelemetryReceiver {
+public:
+    TelemetryReceiver(NetworkManager& network, F1Receiver& f1Receiver, F1TelemetryParser& f1Parser,
+                      PCARSTelemetryParser& pcarsParser, ShiftLight& shiftLight);
+
+    // Returns true if new telemetry was decoded into data
+    bool receive(int game, TelemetryData& data, unsigned long currentTime);
+
+private:
+    NetworkManager& network;
+    F1Receiver& f1Receiver;
+    F1TelemetryParser& f1Parser;
+    PCARSTelemetryParser& pcarsParser;
+    ShiftLight& shiftLight;
+    int lastGame;                 // Game of the last receive(), -1 before the first
+    uint32_t lastEngineSamples[GAME_COUNT];  // Each parser's engineSamples last fed to shiftLight
+
+    bool receiveF1(TelemetryData& data, unsigned long currentTime);
+    bool receivePCARS(TelemetryData& data, unsigned long currentTime);
+};
+
+#endif // TELEMETRY_RECEIVER_H
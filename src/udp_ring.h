@@ -0,0 +1,145 @@
+#ifndef UDP_RING_H
+#define UDP_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+// What the receive callback recorded about one datagram
+struct UdpDatagram {
+    uint16_t size = 0;            // Bytes stored in the slot
+    uint16_t datagramSize = 0;    // Size of the datagram on the wire
+    uint8_t tag = 0;              // Owner-defined (packet ID, listener, ...)
+    IPAddress remoteIP;
+    uint32_t receivedMicros = 0;  // micros() when the network stack handed it over
+};
+
+// Fixed-slot ring of received datagrams, filled from the network stack's
+// receive callback and drained by loop().
+//
+// Single producer, single consumer: every listener's callback runs in the
+// same context (lwIP's on ESP8266, the AsyncUDP task on ESP32), and only
+// loop() reads. The producer never waits - when the ring is full it simply
+// overwrites the oldest slot. Each slot carries a stamp (the write index + 1,
+// 0 while being written), so the consumer copies a slot out and then checks
+// the stamp is unchanged; a slot overwritten underneath it is skipped and
+// counted as dropped, like any slot the producer lapped. Only plain atomic
+// loads and stores are used, which ESP8266 has no trouble with.
+template<uint16_t SlotSize, uint8_t SlotCount>
+class UdpRing {
+public:
+    enum : uint16_t { kSlotSize = SlotSize };
+
+    UdpRing() : head(0), tail(0), dropped(0) {
+        for (uint8_t i = 0; i < SlotCount; i++) {
+            slots[i].stamp.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Producer: returns the next slot's buffer (kSlotSize bytes). The slot
+    // isn't visible until commit(); not committing just abandons it.
+    uint8_t* beginWrite() {
+        Slot& slot = slots[head.load(std::memory_order_relaxed) % SlotCount];
+        slot.stamp.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return slot.data;
+    }
+
+    void commit(const UdpDatagram& datagram) {
+        uint32_t index = head.load(std::memory_order_relaxed);
+        Slot& slot = slots[index % SlotCount];
+        slot.datagram = datagram;
+        slot.stamp.store(index + 1, std::memory_order_release);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    // Consumer: copies the oldest readable slot into buffer (kSlotSize bytes).
+    // Returns false if the ring is empty.
+    bool read(uint8_t* buffer, UdpDatagram& datagram) {
+        for (;;) {
+            uint32_t newest = head.load(std::memory_order_acquire);
+            if (tail == newest) {
+                return false;
+            }
+
+            skipOverwritten(newest);
+
+            Slot& slot = slots[tail % SlotCount];
+            uint32_t stamp = slot.stamp.load(std::memory_order_acquire);
+            if (stamp == tail + 1) {
+                datagram = slot.datagram;
+                // A torn datagram could hold any size, so never copy past the slot
+                memcpy(buffer, slot.data, min(datagram.size, SlotSize));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.stamp.load(std::memory_order_relaxed) == stamp) {
+                    tail++;
+                    return true;
+                }
+            }
+
+            // Overwritten while we looked - it was the oldest, so it's the one lost
+            dropped++;
+            tail++;
+        }
+    }
+
+    // Consumer: the oldest readable slot's datagram, left queued (its data
+    // isn't copied). Returns false if the ring is empty.
+    bool peek(UdpDatagram& datagram) {
+        for (;;) {
+            uint32_t newest = head.load(std::memory_order_acquire);
+            if (tail == newest) {
+                return false;
+            }
+
+            skipOverwritten(newest);
+
+            Slot& slot = slots[tail % SlotCount];
+            uint32_t stamp = slot.stamp.load(std::memory_order_acquire);
+            if (stamp == tail + 1) {
+                datagram = slot.datagram;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.stamp.load(std::memory_order_relaxed) == stamp) {
+                    return true;
+                }
+            }
+
+            dropped++;
+            tail++;
+        }
+    }
+
+    // Consumer: drops everything queued so far, without counting it as dropped
+    void discard() {
+        tail = head.load(std::memory_order_acquire);
+    }
+
+    // Datagrams overwritten before loop() got to them
+    uint32_t getDropped() const {
+        return dropped;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> stamp;
+        UdpDatagram datagram;
+        uint8_t data[SlotSize];
+    };
+
+    Slot slots[SlotCount];
+    std::atomic<uint32_t> head;   // Next index to write, producer only
+    uint32_t tail;                // Next index to read, consumer only
+    uint32_t dropped;             // Consumer only
+
+    // The slot after the newest one may be mid-write, so at most
+    // SlotCount - 1 are readable; anything older was overwritten
+    void skipOverwritten(uint32_t newest) {
+        if (newest - tail > SlotCount - 1u) {
+            uint32_t oldest = newest - (SlotCount - 1u);
+            dropped += oldest - tail;
+            tail = oldest;
+        }
+    }
+};
+
+#endif // UDP_RING_H
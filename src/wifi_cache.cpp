@@ -0,0 +1,79 @@
+#include "wifi_cache.h"
+#include <EEPROM.h>
+#include <stddef.h>
+
+#define WIFI_CACHE_MAGIC 0x43494657   // "WFIC"
+
+// FNV-1a
+#define WIFI_CACHE_HASH_SEED 2166136261u
+#define WIFI_CACHE_HASH_PRIME 16777619u
+
+WiFiCache::WiFiCache() : started(false) {
+}
+
+void WiFiCache::begin() {
+    EEPROM.begin(WIFI_CACHE_EEPROM_OFFSET + sizeof(Record));
+    started = true;
+}
+
+bool WiFiCache::load(WiFiCacheEntry& entry) const {
+    if (!started) {
+        return false;
+    }
+
+    Record record;
+    EEPROM.get(WIFI_CACHE_EEPROM_OFFSET, record);
+    if (record.magic != WIFI_CACHE_MAGIC || record.ssidHash != ssidHash() ||
+        record.checksum != recordChecksum(record)) {
+        return false;
+    }
+
+    entry = record.entry;
+    return entry.channel != 0;
+}
+
+void WiFiCache::save(const WiFiCacheEntry& entry) {
+    if (!started) {
+        return;
+    }
+
+    WiFiCacheEntry current;
+    if (load(current) && memcmp(&current, &entry, sizeof(entry)) == 0) {
+        return;
+    }
+
+    Record record;
+    record.magic = WIFI_CACHE_MAGIC;
+    record.ssidHash = ssidHash();
+    record.entry = entry;
+    record.checksum = recordChecksum(record);
+    EEPROM.put(WIFI_CACHE_EEPROM_OFFSET, record);
+    EEPROM.commit();
+
+    Serial.println("WiFi: cached association saved");
+}
+
+void WiFiCache::forgetLease() {
+    WiFiCacheEntry entry;
+    if (!load(entry) || entry.localIP == 0) {
+        return;
+    }
+    entry.localIP = 0;
+    save(entry);
+}
+
+uint32_t WiFiCache::hash(const uint8_t* data, size_t length) {
+    uint32_t value = WIFI_CACHE_HASH_SEED;
+    for (size_t i = 0; i < length; i++) {
+        value = (value ^ data[i]) * WIFI_CACHE_HASH_PRIME;
+    }
+    return value;
+}
+
+uint32_t WiFiCache::ssidHash() {
+    return hash(reinterpret_cast<const uint8_t*>(WIFI_SSID), strlen(WIFI_SSID));
+}
+
+uint32_t WiFiCache::recordChecksum(const Record& record) {
+    return hash(reinterpret_cast<const uint8_t*>(&record), offsetof(Record, checksum));
+}
@@ -0,0 +1,50 @@
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Last good association, kept in flash (EEPROM emulation) so it survives
+// power cycles. With it, NetworkManager can associate straight to the known
+// access point on its channel and reuse the DHCP lease, skipping the scan and
+// the DHCP exchange that make up most of the time to first packet.
+// No padding, so entries compare with memcmp().
+struct WiFiCacheEntry {
+    uint32_t localIP;             // Lease from the last DHCP exchange
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+};
+
+class WiFiCache {
+public:
+    WiFiCache();
+    void begin();
+
+    // False if nothing is stored, the data is corrupt or it was saved for
+    // another SSID
+    bool load(WiFiCacheEntry& entry) const;
+    // Writes only when the entry changed, to spare the flash
+    void save(const WiFiCacheEntry& entry);
+    // Keeps the AP but clears the lease, so the next fast attempt uses DHCP
+    void forgetLease();
+
+private:
+    struct Record {
+        uint32_t magic;
+        uint32_t ssidHash;        // WIFI_SSID the entry belongs to
+        WiFiCacheEntry entry;
+        uint32_t checksum;        // Over everything above
+    };
+
+    bool started;
+
+    static uint32_t hash(const uint8_t* data, size_t length);
+    static uint32_t ssidHash();
+    static uint32_t recordChecksum(const Record& record);
+};
+
+#endif // WIFI_CACHE_H
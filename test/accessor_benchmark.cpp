@@ -0,0 +1,114 @@
+/*
+ * Field Accessor Benchmark
+ * Compares decoding an F1 2020 car telemetry entry through a packed-struct
+ * cast against the LEField accessors in src/le_fields.h.
+ *
+ * Usage: copy this file to src/main.cpp temporarily (keep the other src/
+ * files for the headers), upload and open the serial monitor.
+ */
+
+#include <Arduino.h>
+#include "telemetry_f1.h"
+
+#define ITERATIONS 20000
+
+typedef F1Layout<F1_PACKET_FORMAT_2020> L;
+
+// Receive buffer laid out as on the wire. The +1 puts the packet at an odd
+// address, as a datagram copied after a peeked header can be.
+static uint8_t storage[sizeof(PacketCarTelemetryData) + 1];
+static uint8_t* packet = storage + 1;
+
+struct DecodedCar {
+    uint16_t speed;
+    float throttle;
+    float brake;
+    int8_t gear;
+    uint16_t engineRPM;
+};
+
+// Old path: cast the buffer to the packed struct
+static void decodeCast(const uint8_t* buffer, uint8_t carIndex, DecodedCar& out) {
+    const PacketCarTelemetryData* p = reinterpret_cast<const PacketCarTelemetryData*>(buffer);
+    const CarTelemetryData& car = p->m_carTelemetryData[carIndex];
+    out.speed = car.m_speed;
+    out.throttle = car.m_throttle;
+    out.brake = car.m_brake;
+    out.gear = car.m_gear;
+    out.engineRPM = car.m_engineRPM;
+}
+
+// New path: byte-assembled loads at compile-time offsets
+static void decodeAccessor(const uint8_t* buffer, uint8_t carIndex, DecodedCar& out) {
+    const uint8_t* car = buffer + L::kHeaderSize + carIndex * L::kTelemetryStride;
+    out.speed = L::TelemetrySpeed::get(car);
+    out.throttle = L::TelemetryThrottle::get(car);
+    out.brake = L::TelemetryBrake::get(car);
+    out.gear = L::TelemetryGear::get(car);
+    out.engineRPM = L::TelemetryEngineRPM::get(car);
+}
+
+static void fillPacket() {
+    for (size_t i = 0; i < sizeof(PacketCarTelemetryData); i++) {
+        packet[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+}
+
+static bool sameCar(const DecodedCar& a, const DecodedCar& b) {
+    // Compare float bit patterns so NaNs from the filler bytes still match
+    return a.speed == b.speed && a.gear == b.gear && a.engineRPM == b.engineRPM &&
+           memcmp(&a.throttle, &b.throttle, sizeof(float)) == 0 &&
+           memcmp(&a.brake, &b.brake, sizeof(float)) == 0;
+}
+
+template<typename Decode>
+static unsigned long timeDecode(Decode decode, uint32_t& checksum) {
+    DecodedCar car;
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        decode(packet, i % F1_MAX_CARS, car);
+        checksum += car.speed + car.engineRPM + car.gear;
+    }
+    return micros() - start;
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000); // Give serial time to initialize
+
+    Serial.println("\nField Accessor Benchmark");
+    Serial.println("========================");
+    Serial.printf("Packet: %u bytes at %p\n", (unsigned)sizeof(PacketCarTelemetryData), packet);
+    Serial.printf("Iterations: %d\n\n", ITERATIONS);
+
+    fillPacket();
+
+    // Both paths must agree before the timings mean anything
+    for (uint8_t i = 0; i < F1_MAX_CARS; i++) {
+        DecodedCar a, b;
+        decodeCast(packet, i, a);
+        decodeAccessor(packet, i, b);
+        if (!sameCar(a, b)) {
+            Serial.printf("MISMATCH at car %d: speed %u/%u, rpm %u/%u, gear %d/%d\n",
+                         i, a.speed, b.speed, a.engineRPM, b.engineRPM, a.gear, b.gear);
+            return;
+        }
+    }
+    Serial.println("Decoded values match");
+}
+
+void loop() {
+    uint32_t castSum = 0;
+    uint32_t accessorSum = 0;
+    unsigned long castTime = timeDecode(decodeCast, castSum);
+    unsigned long accessorTime = timeDecode(decodeAccessor, accessorSum);
+
+    Serial.printf("Cast:     %lu us (%.3f us/decode)\n", castTime, (float)castTime / ITERATIONS);
+    Serial.printf("Accessor: %lu us (%.3f us/decode)\n", accessorTime, (float)accessorTime / ITERATIONS);
+    if (castSum != accessorSum) {
+        Serial.println("Checksum mismatch!");
+    }
+    Serial.println();
+
+    delay(5000);
+}
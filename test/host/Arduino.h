@@ -0,0 +1,114 @@
+/*
+ * Host stand-in for the few Arduino APIs the dashboard renderer and the
+ * receive path use, so src/dashboard_*.h and the parsers build with a desktop
+ * compiler (see headless_display.h and alloc_test.cpp).
+ *
+ * millis() and micros() run off hostClock: the real clock by default, or a
+ * fixed time when a test freezes it, so rendered text like "Age: 2s" and
+ * "Draw 0us" comes out the same on every run.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+using std::min;
+using std::max;
+
+#define constrain(value, low, high) ((value) < (low) ? (low) : ((value) > (high) ? (high) : (value)))
+
+struct HostClock {
+    bool frozen;
+    unsigned long frozenMicros;
+
+    static HostClock& instance() {
+        static HostClock clock = { false, 0 };
+        return clock;
+    }
+
+    static unsigned long now() {
+        static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (instance().frozen) {
+            return instance().frozenMicros;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    static void freeze(unsigned long micros) {
+        instance().frozen = true;
+        instance().frozenMicros = micros;
+    }
+
+    static void thaw() {
+        instance().frozen = false;
+    }
+};
+
+inline unsigned long micros() {
+    return HostClock::now();
+}
+
+inline unsigned long millis() {
+    return HostClock::now() / 1000;
+}
+
+// IPv4 address stored as the cores store it: first octet in the low byte
+class IPAddress {
+public:
+    IPAddress() : address(0) {}
+    IPAddress(uint32_t address) : address(address) {}
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) :
+        address(first | (uint32_t)second << 8 | (uint32_t)third << 16 | (uint32_t)fourth << 24) {}
+    operator uint32_t() const { return address; }
+    uint8_t operator[](int index) const { return (address >> (8 * index)) & 0xFF; }
+
+private:
+    uint32_t address;
+};
+
+// printf() formats into 64 bytes on the stack and takes a heap buffer for
+// anything longer, like the ESP8266 and ESP32 cores' Print::printf, so a long
+// line on a hot path shows up in the allocation test
+struct HostSerial {
+    void println(const char* text) { fprintf(stderr, "%s\n", text); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char local[64];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(local, sizeof(local), format, args);
+        va_end(args);
+        if (length < 0) {
+            return 0;
+        }
+        if (length < (int)sizeof(local)) {
+            fputs(local, stderr);
+            return length;
+        }
+        char* text = static_cast<char*>(malloc(length + 1));
+        if (text == nullptr) {
+            return 0;
+        }
+        va_start(args, format);
+        vsnprintf(text, length + 1, format, args);
+        va_end(args);
+        fputs(text, stderr);
+        free(text);
+        return length;
+    }
+};
+
+static HostSerial Serial __attribute__((unused));
+
+#endif // HOST_ARDUINO_H
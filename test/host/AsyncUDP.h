@@ -0,0 +1,76 @@
+/*
+ * Host stand-in for the ESP32 AsyncUDP listeners NetworkManager opens. A test
+ * hands a datagram to whichever listener is bound to its port with
+ * AsyncUDP::deliver(), which calls the onPacket() handler the way the AsyncUDP
+ * task would.
+ */
+
+#ifndef HOST_ASYNC_UDP_H
+#define HOST_ASYNC_UDP_H
+
+#include <functional>
+#include "Arduino.h"
+
+#define HOST_UDP_LISTENERS 8
+
+class AsyncUDPPacket {
+public:
+    AsyncUDPPacket(const uint8_t* data, size_t length, IPAddress remoteIP, uint16_t remotePort) :
+        payload(data), size(length), sender(remoteIP), senderPort(remotePort) {}
+
+    const uint8_t* data() const { return payload; }
+    size_t length() const { return size; }
+    IPAddress remoteIP() const { return sender; }
+    uint16_t remotePort() const { return senderPort; }
+
+private:
+    const uint8_t* payload;
+    size_t size;
+    IPAddress sender;
+    uint16_t senderPort;
+};
+
+class AsyncUDP {
+public:
+    typedef std::function<void(AsyncUDPPacket&)> PacketHandler;
+
+    AsyncUDP() : port(0) {}
+
+    bool listen(uint16_t listenPort) {
+        AsyncUDP** listeners = bound();
+        for (int i = 0; i < HOST_UDP_LISTENERS; i++) {
+            if (listeners[i] == nullptr || listeners[i] == this) {
+                listeners[i] = this;
+                port = listenPort;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void onPacket(PacketHandler packetHandler) { handler = packetHandler; }
+
+    // Test side: false if nothing listens on port
+    static bool deliver(uint16_t port, const void* data, size_t length, IPAddress remoteIP, uint16_t remotePort) {
+        AsyncUDP** listeners = bound();
+        for (int i = 0; i < HOST_UDP_LISTENERS; i++) {
+            if (listeners[i] != nullptr && listeners[i]->port == port && listeners[i]->handler) {
+                AsyncUDPPacket packet(static_cast<const uint8_t*>(data), length, remoteIP, remotePort);
+                listeners[i]->handler(packet);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    uint16_t port;
+    PacketHandler handler;
+
+    static AsyncUDP** bound() {
+        static AsyncUDP* listeners[HOST_UDP_LISTENERS] = {};
+        return listeners;
+    }
+};
+
+#endif // HOST_ASYNC_UDP_H
@@ -0,0 +1,45 @@
+/*
+ * Host stand-in for the cores' EEPROM emulation (WiFiCache keeps the last
+ * association there): a RAM array that starts erased, as fresh flash does.
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include "Arduino.h"
+
+#define HOST_EEPROM_SIZE 512
+
+class HostEEPROM {
+public:
+    static HostEEPROM& instance() {
+        static HostEEPROM eeprom;
+        return eeprom;
+    }
+
+    void begin(size_t) {}
+    bool commit() { return true; }
+
+    template<typename T>
+    T& get(int address, T& value) const {
+        memcpy(&value, bytes + address, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    const T& put(int address, const T& value) {
+        memcpy(bytes + address, &value, sizeof(T));
+        return value;
+    }
+
+private:
+    uint8_t bytes[HOST_EEPROM_SIZE];
+
+    HostEEPROM() {
+        memset(bytes, 0xFF, sizeof(bytes));
+    }
+};
+
+static HostEEPROM& EEPROM __attribute__((unused)) = HostEEPROM::instance();
+
+#endif // HOST_EEPROM_H
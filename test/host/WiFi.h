@@ -0,0 +1,70 @@
+/*
+ * Host stand-in for the ESP32 WiFi API NetworkManager uses. Nothing is sent;
+ * a test raises the station events itself (WiFi.raiseEvent()) to walk the
+ * connection state machine, e.g. to CONNECTED so the UDP listeners open.
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <functional>
+#include "Arduino.h"
+
+enum WiFiMode_t { WIFI_OFF, WIFI_STA };
+
+enum WiFiEvent_t {
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED
+};
+
+struct WiFiEventInfo_t {
+};
+
+class HostWiFi {
+public:
+    typedef std::function<void(WiFiEvent_t, WiFiEventInfo_t)> EventHandler;
+
+    // One object for the whole program, whichever file names WiFi
+    static HostWiFi& instance() {
+        static HostWiFi wifi;
+        return wifi;
+    }
+
+    void persistent(bool) {}
+    void setAutoReconnect(bool) {}
+    void mode(WiFiMode_t) {}
+    void onEvent(EventHandler handler) { eventHandler = handler; }
+
+    void begin(const char*, const char*, int32_t channel = 0, const uint8_t* bssid = nullptr) {
+        (void)channel;
+        (void)bssid;
+    }
+    bool config(IPAddress local, IPAddress, IPAddress, IPAddress = IPAddress()) {
+        localAddress = local;
+        return true;
+    }
+    bool disconnect() { return true; }
+
+    IPAddress localIP() const { return localAddress; }
+    IPAddress gatewayIP() const { return IPAddress(); }
+    IPAddress subnetMask() const { return IPAddress(); }
+    IPAddress dnsIP(int = 0) const { return IPAddress(); }
+    const uint8_t* BSSID() const { return bssid; }
+    int32_t channel() const { return 1; }
+
+    // Test side: deliver a station event as the WiFi task would
+    void raiseEvent(WiFiEvent_t event) {
+        if (eventHandler) {
+            eventHandler(event, WiFiEventInfo_t());
+        }
+    }
+
+private:
+    EventHandler eventHandler;
+    IPAddress localAddress;
+    uint8_t bssid[6] = { 0x02, 0, 0, 0, 0, 1 };
+};
+
+static HostWiFi& WiFi __attribute__((unused)) = HostWiFi::instance();
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,323 @@
+/*
+ * Heap allocation test for the per-packet and per-frame paths
+ * Runs the device's receive code on the host: datagrams go in through the
+ * AsyncUDP callbacks NetworkManager registers (header check, sender pin,
+ * receive rings), GameSelector follows whichever game is sending, and
+ * TelemetryReceiver drains the rings through F1Receiver or the PCARS parser
+ * into TelemetryData and the shift cue, exactly as receiveTelemetry() does.
+ * The data then goes through a SnapshotBuffer, as on ESP32, and every page,
+ * pageKey() and the RPM bar fast path are drawn from it on both headless
+ * panels.
+ *
+ * One pass of the whole sequence - F1, a switch to PCARS (game packets,
+ * forwarder frames and forwarder JSON), a switch back - is run first so
+ * statics and the WiFi cache are set up. The same sequence is then run again
+ * with every malloc, calloc and realloc counted, operator new included; none
+ * of it may touch the heap: on the ESP8266 a long session of small
+ * allocations fragments it until a large one fails.
+ *
+ * Usage (from the repository root, GNU ld for --wrap; ArduinoJson is the
+ * copy PlatformIO fetched for lib_deps):
+ *   g++ -std=gnu++11 -O2 -Wall -Itest/host -Iinclude -Isrc \
+ *       -I.pio/libdeps/esp32dev/ArduinoJson/src \
+ *       test/host/alloc_test.cpp src/dashboard_layouts.cpp src/telemetry_f1.cpp \
+ *       src/telemetry_pcars.cpp src/shift_light.cpp src/network_manager.cpp \
+ *       src/f1_receiver.cpp src/sender_pin.cpp src/wifi_cache.cpp \
+ *       src/game_selector.cpp src/telemetry_receiver.cpp \
+ *       -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -o alloc_test
+ *   ./alloc_test                      # exit 1 if anything allocated
+ *
+ * Build it with DEBUG_UDP as config.h has it. Serial.printf here allocates
+ * for lines over 64 bytes, as the cores' does, so debug lines long enough to
+ * allocate on the device fail the test too.
+ */
+
+#include <stdlib.h>
+#include <new>
+#include "headless_display.h"
+#include "render_scenarios.h"
+#include "network_manager.h"
+#include "f1_receiver.h"
+#include "game_selector.h"
+#include "shift_light.h"
+#include "telemetry_receiver.h"
+#include "snapshot_buffer.h"
+
+#define ALLOC_TEST_PHASE_PASSES 200
+#define ALLOC_TEST_PASS_MS 20
+
+static bool counting = false;
+static unsigned long allocations = 0;
+
+// The linker sends every malloc, calloc and realloc call in the test and the
+// sources under test here (-Wl,--wrap); __real_* is the C library's
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* block, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* block, size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    return __real_realloc(block, size);
+}
+}
+
+// libstdc++'s own operator new calls malloc from inside the shared library,
+// out of --wrap's reach, so route it through the wrapped malloc here
+void* operator new(size_t size) {
+    void* block = malloc(size ? size : 1);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    free(block);
+}
+
+// One rig on the LAN sends everything; each listener pins it
+static const IPAddress SENDER_IP(192, 168, 43, 10);
+
+static NetworkManager network;
+static F1TelemetryParser f1Parser;
+static PCARSTelemetryParser pcarsParser;
+static F1Receiver f1Receiver(network, f1Parser);
+static GameSelector gameSelector(network);
+static ShiftLight shiftLight;
+static TelemetryReceiver receiver(network, f1Receiver, f1Parser, pcarsParser, shiftLight);
+static SnapshotBuffer<TelemetryData> snapshot;
+static TelemetryData telemetryData;
+static HeadlessSH1106 sh1106;
+static HeadlessSSD1306 ssd1306;
+
+static unsigned long now = 1000;       // ms; 0 reads as "no packet yet" to NetworkManager
+static uint32_t f1Frame = 0;
+static uint32_t pcarsPacketNumber = 0;
+static uint16_t forwarderSequence = 0;
+
+// 2020 packets from the documented structures; the player is car 0
+static PacketCarTelemetryData telemetryPacket;
+static PacketLapData lapPacket;
+static PacketCarStatusData statusPacket;
+
+static uint8_t pcarsTelemetry[PCARS2Layout::kTelemetrySize];
+static uint8_t forwarderFrame[PCARSForwarderLayout::kSize];
+
+static void setHeader(PacketHeader& header, uint8_t packetId) {
+    header.m_packetFormat = F1_PACKET_FORMAT_2020;
+    header.m_packetId = packetId;
+    header.m_frameIdentifier = ++f1Frame;
+    header.m_playerCarIndex = 0;
+}
+
+static void sendF1(int pass) {
+    CarTelemetryData& car = telemetryPacket.m_carTelemetryData[0];
+    car.m_speed = (pass * 7) % 330;
+    car.m_gear = pass % 9 - 1;
+    car.m_engineRPM = (pass * 131) % 12000;
+    car.m_revLightsPercent = car.m_engineRPM / 120;
+    lapPacket.m_lapData[0].m_lastLapTime = 80.0f + (pass % 100) * 0.137f;
+    lapPacket.m_lapData[0].m_carPosition = 1 + pass % 20;
+    statusPacket.m_carStatusData[0].m_fuelInTank = 100.0f - (pass % 100);
+    statusPacket.m_carStatusData[0].m_fuelCapacity = 110.0f;
+    statusPacket.m_carStatusData[0].m_maxRPM = 12000;
+
+    setHeader(telemetryPacket.m_header, F1_PACKET_ID_CAR_TELEMETRY);
+    setHeader(lapPacket.m_header, F1_PACKET_ID_LAP_DATA);
+    setHeader(statusPacket.m_header, F1_PACKET_ID_CAR_STATUS);
+    AsyncUDP::deliver(F1_UDP_PORT, &telemetryPacket, sizeof(telemetryPacket), SENDER_IP, F1_UDP_PORT);
+    AsyncUDP::deliver(F1_UDP_PORT, &lapPacket, sizeof(lapPacket), SENDER_IP, F1_UDP_PORT);
+    AsyncUDP::deliver(F1_UDP_PORT, &statusPacket, sizeof(statusPacket), SENDER_IP, F1_UDP_PORT);
+}
+
+// Stores a field the way the game and the forwarder send it; the host is
+// little-endian like them
+template<typename Field>
+void setField(uint8_t* base, typename Field::Type value) {
+    memcpy(base + Field::kOffset, &value, sizeof(value));
+}
+
+// CRC16-CCITT, poly 0x1021, init 0xFFFF, as pcars_forwarder.py sends it
+static uint16_t crc16CCITT(const uint8_t* data, int length) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// A game packet, a forwarder frame or forwarder JSON, in turn
+static void sendPCARS(int pass) {
+    if (pass % 3 == 0) {
+        typedef PCARS2Layout L;
+        setField<L::PacketNumber>(pcarsTelemetry, ++pcarsPacketNumber);
+        setField<L::PacketType>(pcarsTelemetry, PCARS2_PACKET_TELEMETRY);
+        setField<L::TelemetryViewedParticipant>(pcarsTelemetry, 0);
+        setField<L::TelemetryFuelCapacity>(pcarsTelemetry, 100);
+        setField<L::TelemetryFuelLevel>(pcarsTelemetry, 0.5f);
+        setField<L::TelemetrySpeed>(pcarsTelemetry, (pass % 90) * 1.0f);
+        setField<L::TelemetryRpm>(pcarsTelemetry, (pass * 97) % 9000);
+        setField<L::TelemetryMaxRpm>(pcarsTelemetry, 9000);
+        setField<L::TelemetryGearNumGears>(pcarsTelemetry, 0x60 | (pass % 7));
+        AsyncUDP::deliver(PCARS_UDP_PORT, pcarsTelemetry, sizeof(pcarsTelemetry), SENDER_IP, PCARS_UDP_PORT);
+    } else if (pass % 3 == 1) {
+        typedef PCARSForwarderLayout L;
+        setField<L::Magic>(forwarderFrame, PCARS_FORWARDER_MAGIC);
+        setField<L::Version>(forwarderFrame, PCARS_FORWARDER_VERSION);
+        setField<L::Sequence>(forwarderFrame, ++forwarderSequence);
+        setField<L::Timestamp>(forwarderFrame, now);
+        setField<L::Speed>(forwarderFrame, 120.0f + pass % 60);
+        setField<L::Rpm>(forwarderFrame, (pass * 53) % 9000);
+        setField<L::Gear>(forwarderFrame, pass % 7);
+        setField<L::Fuel>(forwarderFrame, 48.5f);
+        setField<L::LapTime>(forwarderFrame, 91.25f);
+        setField<L::Crc>(forwarderFrame, crc16CCITT(forwarderFrame, L::Crc::kOffset));
+        AsyncUDP::deliver(PCARS_FORWARDER_PORT, forwarderFrame, sizeof(forwarderFrame), SENDER_IP, 50000);
+    } else {
+        char json[96];
+        int length = snprintf(json, sizeof(json),
+                              "{\"speed\": %d.5, \"gear\": %d, \"rpm\": %d, \"fuel\": 63.8, \"lapTime\": 92.517}",
+                              150 + pass % 60, pass % 7, (pass * 71) % 9000);
+        AsyncUDP::deliver(PCARS_FORWARDER_PORT, json, length, SENDER_IP, 50000);
+    }
+}
+
+template<typename Display>
+void drawFrames(Display& display, const TelemetryData& data, int game) {
+    for (int page = 0; page < MAX_PAGES; page++) {
+        display.pageKey(page, data, game);
+        display.showPage(page, data, game);
+    }
+    display.showRpmBar(data);
+}
+
+// What the telemetry and render tasks do between two datagram bursts
+static void runLoop(int game) {
+    network.update(now);
+    gameSelector.update(now);
+    if (receiver.receive(gameSelector.getGame(), telemetryData, now)) {
+        snapshot.back() = telemetryData;
+        snapshot.publish();
+    }
+    snapshot.update();
+    drawFrames(sh1106, snapshot.front(), game);
+    drawFrames(ssd1306, snapshot.front(), game);
+
+    now += ALLOC_TEST_PASS_MS;
+    HostClock::freeze(now * 1000);
+}
+
+// Sends one game's datagrams until the selector has picked it and each
+// kind has been decoded; false if that doesn't happen
+static bool runPhase(int game, int& pass) {
+    uint8_t seenTypes = 0;
+    for (int i = 0; i < ALLOC_TEST_PHASE_PASSES; i++, pass++) {
+        if (game == GAME_F1) {
+            sendF1(pass);
+        } else {
+            sendPCARS(pass);
+        }
+        runLoop(game);
+        if (gameSelector.getGame() == game && telemetryData.dataValid) {
+            if (game == GAME_F1) {
+                seenTypes |= 1u << (telemetryData.lastPacketType - PACKET_F1_MOTION);
+            } else {
+                seenTypes |= 1u << (telemetryData.lastPacketType - PACKET_PCARS_UDP);
+            }
+        }
+    }
+    if (gameSelector.getGame() != game || seenTypes == 0) {
+        return false;
+    }
+    if (game == GAME_PCARS) {
+        // Game packets, forwarder frames and JSON all came through
+        return seenTypes == (1u << (PACKET_PCARS_UDP - PACKET_PCARS_UDP) |
+                             1u << (PACKET_PCARS_FORWARDER - PACKET_PCARS_UDP) |
+                             1u << (PACKET_PCARS_JSON - PACKET_PCARS_UDP));
+    }
+    const CarTelemetryData& car = telemetryPacket.m_carTelemetryData[0];
+    return telemetryData.speed == car.m_speed && telemetryData.rpm == car.m_engineRPM &&
+           telemetryData.position == lapPacket.m_lapData[0].m_carPosition;
+}
+
+static bool runSequence(int& pass) {
+    return runPhase(GAME_F1, pass) && runPhase(GAME_PCARS, pass) && runPhase(GAME_F1, pass);
+}
+
+int main() {
+    HostClock::freeze(now * 1000);
+
+    // setup(), then the station gets its address
+    network.attachF1Parser(f1Parser);
+    gameSelector.begin(GAME_F1);
+    network.begin();
+    f1Parser.begin();
+    pcarsParser.begin();
+    WiFi.raiseEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    network.update(now);
+    if (!network.isConnected()) {
+        printf("FAIL the UDP listeners did not open\n");
+        return 1;
+    }
+
+    // The first sequence may set up statics; after that nothing should allocate
+    int pass = 0;
+    if (!runSequence(pass)) {
+        printf("FAIL a test packet was not decoded\n");
+        return 1;
+    }
+
+    int firstPass = pass;
+    counting = true;
+    bool decoded = runSequence(pass);
+    for (size_t i = 0; i < RENDER_SCENARIO_COUNT; i++) {
+        renderScenario(sh1106, RENDER_SCENARIOS[i]);
+        renderScenario(ssd1306, RENDER_SCENARIOS[i]);
+    }
+    counting = false;
+
+    if (!decoded) {
+        printf("FAIL a test packet was not decoded\n");
+        return 1;
+    }
+    int passes = pass - firstPass;
+    printf("%lu heap allocations in %d receive passes and %d frames\n", allocations,
+           passes, 2 * passes * (MAX_PAGES + 1) + 2 * (int)RENDER_SCENARIO_COUNT);
+    return allocations ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * Headless dashboard backend: draws the real pages (src/dashboard_renderer.h)
+ * with a panel's real layout (src/dashboard_layouts.h) into a framebuffer in
+ * memory, so they can be looked at (PBM) and timed without an OLED attached.
+ *
+ * The buffer has the SH1106/SSD1306 page layout: byte (y / 8) * Width + x
+ * holds 8 vertical pixels, bit 0 at the top. Text uses a built-in 5x7 font,
+ * 6 pixels per character, doubled for FONT_LARGE - the same metrics as the
+ * SSD1306's GFX font, close to the SH1106's U8g2 fonts. Glyph shapes on the
+ * SH1106 differ from the device, but positions, clipping, which elements are
+ * drawn and the render cache are exactly the device code's.
+ */
+
+#ifndef HEADLESS_DISPLAY_H
+#define HEADLESS_DISPLAY_H
+
+#include "Arduino.h"
+#include "dashboard_renderer.h"
+#include "dashboard_layouts.h"
+
+// Classic 5x7 font, printable ASCII: 5 columns per glyph, bit 0 at the top
+static const uint8_t HEADLESS_FONT[95][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 },
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },
+    { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 },
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+    { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 },
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+    { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 },
+    { 0x00, 0x56, 0x36, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },
+    { 0x41, 0x22, 0x14, 0x08, 0x00 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, { 0x32, 0x49, 0x79, 0x41, 0x3E },
+    { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x01, 0x01 },
+    { 0x3E, 0x41, 0x41, 0x51, 0x32 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 },
+    { 0x7F, 0x02, 0x04, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 },
+    { 0x46, 0x49, 0x49, 0x49, 0x31 }, { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F }, { 0x63, 0x14, 0x08, 0x14, 0x63 },
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x00, 0x7F, 0x41, 0x41 },
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x41, 0x41, 0x7F, 0x00, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 },
+    { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 },
+    { 0x7F, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 }, { 0x38, 0x44, 0x44, 0x48, 0x7F },
+    { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x08, 0x7E, 0x09, 0x01, 0x02 }, { 0x08, 0x14, 0x54, 0x54, 0x3C },
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x44, 0x3D, 0x00 },
+    { 0x00, 0x7F, 0x10, 0x28, 0x44 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x18, 0x04, 0x78 },
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0x7C, 0x14, 0x14, 0x14, 0x08 },
+    { 0x08, 0x14, 0x14, 0x18, 0x7C }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 },
+    { 0x04, 0x3F, 0x44, 0x40, 0x20 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C },
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0C, 0x50, 0x50, 0x50, 0x3C },
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x7F, 0x00, 0x00 },
+    { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x08, 0x08, 0x2A, 0x1C, 0x08 },
+};
+
+// Backend primitive calls, for the benchmark
+struct HeadlessDrawCounts {
+    uint32_t strings;
+    uint32_t boxes;               // drawFrame(), drawBox() and clearBox()
+    uint32_t clears;
+    uint32_t frames;
+    uint32_t rowSends;            // sendRows()
+};
+
+template<int Width, int Height, const DashboardLayout& Layout>
+class HeadlessDisplay : public DashboardRenderer<HeadlessDisplay<Width, Height, Layout> > {
+public:
+    enum { WIDTH = Width, HEIGHT = Height, FRAME_BYTES = Width * Height / 8 };
+
+    HeadlessDisplay() : textScale(1), counts() {
+        memset(buffer, 0, sizeof(buffer));
+        this->buildRenderCache();
+        resetCounts();
+    }
+
+    const uint8_t* pixels() const {
+        return buffer;
+    }
+
+    bool pixel(int16_t x, int16_t y) const {
+        return buffer[(y / 8) * Width + x] & (1 << (y & 7));
+    }
+
+    // Binary PBM (P4): rows of pixels, 1 = lit, MSB first
+    bool writePbm(const char* path) const {
+        FILE* file = fopen(path, "wb");
+        if (!file) {
+            return false;
+        }
+        fprintf(file, "P4\n%d %d\n", Width, Height);
+        for (int16_t y = 0; y < Height; y++) {
+            for (int16_t x = 0; x < Width; x += 8) {
+                uint8_t bits = 0;
+                for (int16_t bit = 0; bit < 8; bit++) {
+                    if (pixel(x + bit, y)) {
+                        bits |= 0x80 >> bit;
+                    }
+                }
+                fputc(bits, file);
+            }
+        }
+        fclose(file);
+        return true;
+    }
+
+    // Reads a PBM written by writePbm() back into the panel's buffer layout
+    static bool readPbm(const char* path, uint8_t* frame) {
+        FILE* file = fopen(path, "rb");
+        if (!file) {
+            return false;
+        }
+        int width = 0;
+        int height = 0;
+        bool ok = fscanf(file, "P4 %d %d", &width, &height) == 2 && fgetc(file) != EOF &&
+                  width == Width && height == Height;
+        memset(frame, 0, FRAME_BYTES);
+        for (int16_t y = 0; ok && y < Height; y++) {
+            for (int16_t x = 0; ok && x < Width; x += 8) {
+                int bits = fgetc(file);
+                ok = bits != EOF;
+                for (int16_t bit = 0; ok && bit < 8; bit++) {
+                    if (bits & (0x80 >> bit)) {
+                        frame[(y / 8) * Width + x + bit] |= 1 << (y & 7);
+                    }
+                }
+            }
+        }
+        fclose(file);
+        return ok;
+    }
+
+    HeadlessDrawCounts getDrawCounts() const {
+        return counts;
+    }
+
+    void resetCounts() {
+        memset(&counts, 0, sizeof(counts));
+    }
+
+    DisplayFlushStats getFlushStats() const {
+        return flushStats;
+    }
+
+private:
+    friend class DashboardRenderer<HeadlessDisplay>;
+
+    static const DashboardLayout& layout;
+
+    uint8_t buffer[FRAME_BYTES];
+#if DISPLAY_RENDER_CACHE
+    DashboardCache<Width, Height> renderCache;
+#endif
+    uint8_t textScale;
+    HeadlessDrawCounts counts;
+    DisplayFlushStats flushStats;
+
+    void setPixel(int16_t x, int16_t y) {
+        if (x >= 0 && x < Width && y >= 0 && y < Height) {
+            buffer[(y / 8) * Width + x] |= 1 << (y & 7);
+        }
+    }
+
+    // DashboardRenderer primitives
+    void clearFrame() {
+        memset(buffer, 0, sizeof(buffer));
+        counts.clears++;
+    }
+
+    // Nothing to send; report what a full-frame panel would have
+    void sendFrame() {
+        flushStats.tilesSent = FRAME_BYTES / 8;
+        flushStats.bytesSent = FRAME_BYTES;
+        flushStats.flushMicros = 0;
+        counts.frames++;
+    }
+
+    void sendFrameNow() {
+        sendFrame();
+    }
+
+    // Tile rows y to y + height - 1, as the SH1106 would send them
+    void sendRows(int16_t y, int16_t height) {
+        flushStats.tilesSent = ((y + height - 1) / 8 - y / 8 + 1) * (Width / 8);
+        flushStats.bytesSent = flushStats.tilesSent * 8;
+        flushStats.flushMicros = 0;
+        counts.rowSends++;
+    }
+
+    void setFont(DisplayFont font) {
+        textScale = font == FONT_LARGE ? 2 : 1;
+    }
+
+    void drawString(int16_t x, int16_t y, const char* text) {
+        int16_t top = y - 7 * textScale;
+        for (const char* c = text; *c; c++, x += 6 * textScale) {
+            if (*c < ' ' || *c > '~') {
+                continue;
+            }
+            const uint8_t* glyph = HEADLESS_FONT[*c - ' '];
+            for (int16_t column = 0; column < 5 * textScale; column++) {
+                uint8_t bits = glyph[column / textScale];
+                for (int16_t row = 0; row < 7 * textScale; row++) {
+                    if (bits & (1 << (row / textScale))) {
+                        setPixel(x + column, top + row);
+                    }
+                }
+            }
+        }
+        counts.strings++;
+    }
+
+    int16_t stringWidth(const char* text) {
+        return strlen(text) * 6 * textScale;
+    }
+
+    void drawFrame(int16_t x, int16_t y, int16_t width, int16_t height) {
+        for (int16_t i = 0; i < width; i++) {
+            setPixel(x + i, y);
+            setPixel(x + i, y + height - 1);
+        }
+        for (int16_t i = 0; i < height; i++) {
+            setPixel(x, y + i);
+            setPixel(x + width - 1, y + i);
+        }
+        counts.boxes++;
+    }
+
+    void drawBox(int16_t x, int16_t y, int16_t width, int16_t height) {
+        for (int16_t i = 0; i < width; i++) {
+            for (int16_t j = 0; j < height; j++) {
+                setPixel(x + i, y + j);
+            }
+        }
+        counts.boxes++;
+    }
+
+    void clearBox(int16_t x, int16_t y, int16_t width, int16_t height) {
+        for (int16_t i = 0; i < width; i++) {
+            for (int16_t j = 0; j < height; j++) {
+                if (x + i >= 0 && x + i < Width && y + j >= 0 && y + j < Height) {
+                    buffer[((y + j) / 8) * Width + x + i] &= ~(1 << ((y + j) & 7));
+                }
+            }
+        }
+        counts.boxes++;
+    }
+
+    uint8_t* frameBuffer() {
+        return buffer;
+    }
+};
+
+template<int Width, int Height, const DashboardLayout& Layout>
+const DashboardLayout& HeadlessDisplay<Width, Height, Layout>::layout = Layout;
+
+typedef HeadlessDisplay<128, 64, SH1106_LAYOUT> HeadlessSH1106;
+typedef HeadlessDisplay<128, 32, SSD1306_LAYOUT> HeadlessSSD1306;
+
+#endif // HEADLESS_DISPLAY_H
@@ -0,0 +1,96 @@
+/*
+ * Render Benchmark
+ * Times showPage() on the headless SH1106 and SSD1306 backends for each page,
+ * with the telemetry changing every frame, and counts the backend draw calls
+ * a frame makes, then the RPM bar fast path (showRpmBar()) the same way.
+ * Host numbers don't match the ESP's, but a change that makes a page slower
+ * or draw more shows up here.
+ *
+ * Usage (from the repository root):
+ *   g++ -std=gnu++11 -O2 -Wall -Itest/host -Iinclude -Isrc \
+ *       test/host/render_benchmark.cpp src/dashboard_layouts.cpp -o render_benchmark
+ *   ./render_benchmark                  # print the table
+ *   ./render_benchmark --budget-us 20   # also exit 1 if any page averages more
+ *
+ * Build again with -DDISPLAY_RENDER_CACHE=0 to compare against the uncached
+ * path.
+ */
+
+#include <stdlib.h>
+#include "headless_display.h"
+#include "render_scenarios.h"
+
+#define BENCH_FRAMES 20000
+
+static const char* pageNames[MAX_PAGES] = { "speed", "lap", "debug", "settings" };
+
+static bool overBudget = false;
+
+template<typename Display>
+void benchPanel(const char* panel, double budgetMicros) {
+    for (int page = 0; page < MAX_PAGES; page++) {
+        Display display;
+        TelemetryData data;
+        scenarioLive(data);
+        display.resetCounts();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+            data.speed = (frame * 7) % 330;
+            data.gear = frame % 9 - 1;
+            data.rpm = (frame * 13) % 12000;
+            data.lapTime = 60.0f + (frame % 1000) * 0.017f;
+            data.fuel = 100.0f - (frame % 1000) * 0.1f;
+            data.lastUpdate = millis();
+            display.showPage(page, data, GAME_F1);
+        }
+        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        HeadlessDrawCounts counts = display.getDrawCounts();
+        double perFrame = elapsed / BENCH_FRAMES;
+        bool over = budgetMicros > 0 && perFrame > budgetMicros;
+        overBudget = overBudget || over;
+        printf("%-8s %-9s %9.2f %8.1f %8.1f %8.1f%s\n", panel, pageNames[page], perFrame,
+               (double)counts.strings / BENCH_FRAMES, (double)counts.boxes / BENCH_FRAMES,
+               (double)counts.clears / BENCH_FRAMES, over ? "  OVER BUDGET" : "");
+    }
+}
+
+template<typename Display>
+void benchRpmBar(const char* panel) {
+    Display display;
+    TelemetryData data;
+    scenarioLive(data);
+    data.maxRPM = 12000;
+    display.showPage(PAGE_SPEED_GEAR, data, GAME_F1);
+    display.resetCounts();
+
+    int sent = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        data.rpm = (frame * 13) % 12000;
+        data.shiftCue = data.rpm > 11500;
+        sent += display.showRpmBar(data) ? 1 : 0;
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    HeadlessDrawCounts counts = display.getDrawCounts();
+    printf("%-8s %-9s %9.2f %8.1f %8.1f %8.1f  (%d of %d packets moved it)\n", panel, "rpm bar",
+           elapsed / BENCH_FRAMES, (double)counts.strings / BENCH_FRAMES,
+           (double)counts.boxes / BENCH_FRAMES, (double)counts.clears / BENCH_FRAMES, sent, BENCH_FRAMES);
+}
+
+int main(int argc, char** argv) {
+    double budgetMicros = 0;
+    if (argc > 2 && strcmp(argv[1], "--budget-us") == 0) {
+        budgetMicros = atof(argv[2]);
+    }
+
+    printf("Render cache: %s, %d frames per page\n", DISPLAY_RENDER_CACHE ? "on" : "off", BENCH_FRAMES);
+    printf("%-8s %-9s %9s %8s %8s %8s\n", "panel", "page", "us/frame", "strings", "boxes", "clears");
+    benchPanel<HeadlessSH1106>("sh1106", budgetMicros);
+    benchPanel<HeadlessSSD1306>("ssd1306", budgetMicros);
+    benchRpmBar<HeadlessSH1106>("sh1106");
+    benchRpmBar<HeadlessSSD1306>("ssd1306");
+    return overBudget ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Golden-image test for the dashboard pages
+ * Draws every scenario in render_scenarios.h on the headless SH1106 (128x64)
+ * and SSD1306 (128x32) backends and compares each frame with
+ * golden/<panel>_<scenario>.pbm. A frame that differs is written next to
+ * the working directory as <panel>_<scenario>.actual.pbm for a look.
+ *
+ * The speed page scenarios are also drawn a second way: the page with other
+ * RPM and shift cue values, then the RPM bar fast path (showRpmBar()) on top
+ * with the scenario's. That has to come out the same as the page itself.
+ *
+ * Usage (from the repository root, any desktop g++ or clang++):
+ *   g++ -std=gnu++11 -O2 -Wall -Itest/host -Iinclude -Isrc \
+ *       test/host/render_golden.cpp src/dashboard_layouts.cpp -o render_golden
+ *   ./render_golden test/host/golden            # compare, exit 1 on a mismatch
+ *   ./render_golden test/host/golden --update   # accept the current frames
+ *
+ * Add -DDISPLAY_RENDER_CACHE=0 to check the uncached path draws the same.
+ */
+
+#include "headless_display.h"
+#include "render_scenarios.h"
+
+static int failures = 0;
+
+template<typename Display>
+int countDifferences(const Display& display, const uint8_t* expected) {
+    int differing = 0;
+    for (int16_t y = 0; y < Display::HEIGHT; y++) {
+        for (int16_t x = 0; x < Display::WIDTH; x++) {
+            bool lit = expected[(y / 8) * Display::WIDTH + x] & (1 << (y & 7));
+            if (display.pixel(x, y) != lit) {
+                differing++;
+            }
+        }
+    }
+    return differing;
+}
+
+template<typename Display>
+void checkRpmBarFastPath(const char* panel, const RenderScenario& scenario) {
+    TelemetryData data;
+    scenario.fill(data);
+    Display page;
+    page.showPage(PAGE_SPEED_GEAR, data, scenario.game);
+
+    TelemetryData before = data;
+    before.rpm = data.rpm > 4000 ? data.rpm - 4000 : data.rpm + 4000;
+    before.shiftCue = !data.shiftCue;
+    Display fastPath;
+    fastPath.showPage(PAGE_SPEED_GEAR, before, scenario.game);
+    fastPath.showRpmBar(data);
+
+    int differing = countDifferences(fastPath, page.pixels());
+    if (differing == 0) {
+        printf("ok   %s_%s (RPM bar fast path)\n", panel, scenario.name);
+        return;
+    }
+    printf("FAIL %s_%s: RPM bar fast path differs from the page in %d pixels\n", panel, scenario.name, differing);
+    failures++;
+}
+
+template<typename Display>
+void checkPanel(const char* panel, const char* goldenDir, bool update) {
+    for (size_t i = 0; i < RENDER_SCENARIO_COUNT; i++) {
+        const RenderScenario& scenario = RENDER_SCENARIOS[i];
+        Display display;
+        renderScenario(display, scenario);
+
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s_%s.pbm", goldenDir, panel, scenario.name);
+        if (update) {
+            if (!display.writePbm(path)) {
+                printf("FAIL %s: can't write\n", path);
+                failures++;
+            }
+            continue;
+        }
+
+        if (scenario.page == PAGE_SPEED_GEAR) {
+            checkRpmBarFastPath<Display>(panel, scenario);
+        }
+
+        uint8_t golden[Display::FRAME_BYTES];
+        if (!Display::readPbm(path, golden)) {
+            printf("FAIL %s: missing or unreadable\n", path);
+            failures++;
+            continue;
+        }
+
+        int differing = countDifferences(display, golden);
+        if (differing == 0) {
+            printf("ok   %s_%s\n", panel, scenario.name);
+            continue;
+        }
+
+        char actual[256];
+        snprintf(actual, sizeof(actual), "%s_%s.actual.pbm", panel, scenario.name);
+        display.writePbm(actual);
+        printf("FAIL %s_%s: %d pixels differ, see %s\n", panel, scenario.name, differing, actual);
+        failures++;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("usage: %s <golden dir> [--update]\n", argv[0]);
+        return 2;
+    }
+    bool update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+    HostClock::freeze(SCENARIO_CLOCK_MICROS);
+    checkPanel<HeadlessSH1106>("sh1106", argv[1], update);
+    checkPanel<HeadlessSSD1306>("ssd1306", argv[1], update);
+
+    if (update) {
+        printf("%s golden images in %s\n", failures ? "FAILED writing" : "Updated", argv[1]);
+    } else {
+        printf("%d of %d frames differ\n", failures, (int)(2 * RENDER_SCENARIO_COUNT));
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Page and game states the host render tests draw: every page, live, stale
+ * and without data, plus the status screen. Shared by render_golden.cpp and
+ * render_benchmark.cpp.
+ */
+
+#ifndef RENDER_SCENARIOS_H
+#define RENDER_SCENARIOS_H
+
+#include "Arduino.h"
+#include "config.h"
+#include "telemetry_model.h"
+
+#define SCENARIO_STATUS -1        // showStatus("Ready!") instead of a page
+
+// Debug page text depends on the time, so tests freeze the clock here
+#define SCENARIO_CLOCK_MICROS 5000000UL
+
+struct RenderScenario {
+    const char* name;
+    int page;
+    int game;
+    void (*fill)(TelemetryData& data);
+};
+
+static void scenarioNoData(TelemetryData&) {
+}
+
+static void scenarioLive(TelemetryData& data) {
+    data.dataValid = true;
+    data.lastUpdate = 4990;
+    data.speed = 212.4f;
+    data.gear = 7;
+    data.rpm = 6000;
+    data.fuel = 42.5f;
+    data.lapTime = 83.456f;
+    data.position = 3;
+    data.lastPacketType = PACKET_F1_CAR_TELEMETRY;
+    data.lastPacketSize = 1347;
+    data.sourceIP = 192 | 168UL << 8 | 43UL << 16 | 10UL << 24;   // 192.168.43.10
+}
+
+static void scenarioStale(TelemetryData& data) {
+    scenarioLive(data);
+    data.dataValid = false;
+    data.stale = true;
+}
+
+static void scenarioNeutral(TelemetryData& data) {
+    scenarioLive(data);
+    data.speed = 0.0f;
+    data.gear = 0;
+    data.rpm = 900;
+}
+
+static void scenarioReverse(TelemetryData& data) {
+    scenarioLive(data);
+    data.speed = 12.0f;
+    data.gear = -1;
+    data.rpm = 2500;
+}
+
+static void scenarioRedline(TelemetryData& data) {
+    scenarioLive(data);
+    data.speed = 305.9f;
+    data.gear = 8;
+    data.rpm = 9000;
+}
+
+// Rev limiter reported, shift cue on
+static void scenarioShift(TelemetryData& data) {
+    scenarioLive(data);
+    data.speed = 248.0f;
+    data.gear = 6;
+    data.rpm = 11300;
+    data.maxRPM = 11800;
+    data.shiftCue = true;
+}
+
+// Out lap: no lap time, fuel or position yet
+static void scenarioOutLap(TelemetryData& data) {
+    scenarioLive(data);
+    data.lapTime = 0.0f;
+    data.fuel = 0.0f;
+    data.position = 0;
+}
+
+static void scenarioCounters(TelemetryData& data) {
+    scenarioLive(data);
+    data.lastUpdate = 3000;
+    data.framesLost = 12;
+    data.framesReordered = 3;
+    data.framesDuplicated = 1;
+    data.framesCoalesced = 140;
+    data.packetsDropped = 7;
+    data.sendersRejected = 2;
+}
+
+static void scenarioPCARS(TelemetryData& data) {
+    scenarioLive(data);
+    data.lastPacketType = PACKET_PCARS_FORWARDER;
+    data.lastPacketSize = 559;
+}
+
+static void scenarioManualGame(TelemetryData& data) {
+    data.gameManual = true;
+}
+
+static const RenderScenario RENDER_SCENARIOS[] = {
+    { "speed_nodata", PAGE_SPEED_GEAR, GAME_F1, scenarioNoData },
+    { "speed_live", PAGE_SPEED_GEAR, GAME_F1, scenarioLive },
+    { "speed_stale", PAGE_SPEED_GEAR, GAME_F1, scenarioStale },
+    { "speed_neutral", PAGE_SPEED_GEAR, GAME_F1, scenarioNeutral },
+    { "speed_reverse", PAGE_SPEED_GEAR, GAME_F1, scenarioReverse },
+    { "speed_redline", PAGE_SPEED_GEAR, GAME_F1, scenarioRedline },
+    { "speed_shift", PAGE_SPEED_GEAR, GAME_F1, scenarioShift },
+    { "lap_nodata", PAGE_LAP_FUEL, GAME_F1, scenarioNoData },
+    { "lap_live", PAGE_LAP_FUEL, GAME_F1, scenarioLive },
+    { "lap_stale", PAGE_LAP_FUEL, GAME_F1, scenarioStale },
+    { "lap_outlap", PAGE_LAP_FUEL, GAME_F1, scenarioOutLap },
+    { "debug_nodata", PAGE_DEBUG, GAME_F1, scenarioNoData },
+    { "debug_f1", PAGE_DEBUG, GAME_F1, scenarioCounters },
+    { "debug_pcars", PAGE_DEBUG, GAME_PCARS, scenarioPCARS },
+    { "debug_stale", PAGE_DEBUG, GAME_F1, scenarioStale },
+    { "settings_f1", PAGE_SETTINGS, GAME_F1, scenarioNoData },
+    { "settings_pcars", PAGE_SETTINGS, GAME_PCARS, scenarioNoData },
+    { "settings_manual", PAGE_SETTINGS, GAME_PCARS, scenarioManualGame },
+    { "status", SCENARIO_STATUS, GAME_F1, scenarioNoData },
+};
+
+#define RENDER_SCENARIO_COUNT (sizeof(RENDER_SCENARIOS) / sizeof(RENDER_SCENARIOS[0]))
+
+template<typename Display>
+void renderScenario(Display& display, const RenderScenario& scenario) {
+    TelemetryData data;
+    scenario.fill(data);
+    if (scenario.page == SCENARIO_STATUS) {
+        display.showStatus("Ready!");
+    } else {
+        display.showPage(scenario.page, data, scenario.game);
+    }
+}
+
+#endif // RENDER_SCENARIOS_H
@@ -0,0 +1,116 @@
+/*
+ * PCARS Forwarder JSON Benchmark
+ * Compares the old forwarder parse (stack copy, DynamicJsonDocument per
+ * packet, containsKey lookups) against PCARSTelemetryParser, which parses in
+ * place into a reused filtered StaticJsonDocument.
+ *
+ * Usage: copy this file to src/main.cpp temporarily (keep the other src/
+ * files for the headers), upload and open the serial monitor. Leave
+ * DEBUG_UDP at its default of 0: with it on the parser prints on every
+ * packet and the timing would be mostly Serial.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "telemetry_pcars.h"
+
+#if DEBUG_UDP
+#error "build with -DDEBUG_UDP=0: parseJSONForwarder's debug prints would be timed, parseLegacy has none"
+#endif
+
+#define ITERATIONS 2000
+
+// Same shape pcars_forwarder.py sends
+static const char payload[] =
+    "{\"speed\": 187.4, \"gear\": 5, \"rpm\": 7342, \"fuel\": 63.8, \"lapTime\": 92.517}";
+
+static PCARSTelemetryParser parser;
+
+struct ForwarderValues {
+    float speed;
+    int gear;
+    int rpm;
+    float fuel;
+    float lapTime;
+};
+
+// Old path, as parseJSONForwarder was before the static document
+static bool parseLegacy(const uint8_t* buffer, int size, ForwarderValues& out) {
+    char jsonBuffer[size + 1];
+    memcpy(jsonBuffer, buffer, size);
+    jsonBuffer[size] = '\0';
+
+    #ifdef ESP8266_BOARD
+    DynamicJsonDocument doc(256);
+    #else
+    DynamicJsonDocument doc(512);
+    #endif
+    if (deserializeJson(doc, jsonBuffer)) {
+        return false;
+    }
+
+    if (doc.containsKey("speed")) out.speed = doc["speed"].as<float>();
+    if (doc.containsKey("gear")) out.gear = doc["gear"].as<int>();
+    if (doc.containsKey("rpm")) out.rpm = doc["rpm"].as<int>();
+    if (doc.containsKey("fuel")) out.fuel = doc["fuel"].as<float>();
+    if (doc.containsKey("lapTime")) out.lapTime = doc["lapTime"].as<float>();
+    return true;
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000); // Give serial time to initialize
+
+    Serial.println("\nPCARS Forwarder JSON Benchmark");
+    Serial.println("==============================");
+    Serial.printf("Payload: %s (%d bytes)\n", payload, (int)strlen(payload));
+    Serial.printf("Iterations: %d\n\n", ITERATIONS);
+
+    parser.begin();
+
+    // Both paths must agree before the timings mean anything
+    ForwarderValues legacy = {};
+    const uint8_t* buffer = reinterpret_cast<const uint8_t*>(payload);
+    int size = strlen(payload);
+    if (!parseLegacy(buffer, size, legacy) || !parser.parsePacket(buffer, size, UDP_SOURCE_PCARS_FORWARDER)) {
+        Serial.println("Parse FAILED");
+        return;
+    }
+    PCARSTelemetryData data = parser.getLatestData();
+    if (data.speed != legacy.speed || data.gear != legacy.gear || data.rpm != legacy.rpm ||
+        data.fuel != legacy.fuel || data.lapTime != legacy.lapTime) {
+        Serial.println("MISMATCH between legacy and current parse");
+        return;
+    }
+    Serial.println("Parsed values match");
+}
+
+void loop() {
+    const uint8_t* buffer = reinterpret_cast<const uint8_t*>(payload);
+    int size = strlen(payload);
+    ForwarderValues legacy = {};
+
+    uint32_t heapBefore = ESP.getFreeHeap();
+    unsigned long start = micros();
+    for (int i = 0; i < ITERATIONS; i++) {
+        parseLegacy(buffer, size, legacy);
+    }
+    unsigned long legacyTime = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < ITERATIONS; i++) {
+        parser.parsePacket(buffer, size, UDP_SOURCE_PCARS_FORWARDER);
+    }
+    unsigned long currentTime = micros() - start;
+    uint32_t heapAfter = ESP.getFreeHeap();
+
+    Serial.printf("Legacy:  %lu us (%.2f us/parse)\n", legacyTime, (float)legacyTime / ITERATIONS);
+    Serial.printf("Current: %lu us (%.2f us/parse)\n", currentTime, (float)currentTime / ITERATIONS);
+    Serial.printf("Free heap: %u -> %u bytes\n", heapBefore, heapAfter);
+    #ifdef ESP8266_BOARD
+    Serial.printf("Heap fragmentation: %d%%\n", ESP.getHeapFragmentation());
+    #endif
+    Serial.println();
+
+    delay(5000);
+}
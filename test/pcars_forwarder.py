@@ -1,20 +1,24 @@
 #!/usr/bin/env python3
 """
 Project CARS 2 UDP Forwarder
-Receives PCARS2 UDP telemetry and forwards simplified JSON to ESP32.
+Receives PCARS2 UDP telemetry and forwards simplified data to ESP32.
 
 This script provides two modes:
 1. UDP Mode: Listen for PCARS2 UDP broadcasts and forward parsed data
 2. Simulator Mode: Generate fake PCARS2 data for testing
 
+Data is sent as a 30-byte binary frame (see FRAME_FORMAT) unless --json is
+given, which sends the older JSON text instead.
+
 Usage:
-    python pcars_forwarder.py [ESP8266_IP] [--simulate]
+    python pcars_forwarder.py [ESP8266_IP] [--simulate] [--json]
 
 Default ESP8266 IP: 192.168.43.100
 """
 
 import socket
 import json
+import binascii
 import time
 import sys
 import struct
@@ -26,10 +30,33 @@ PCARS_UDP_PORT = 5606
 ESP32_FORWARDER_PORT = 20778
 DEFAULT_ESP8266_IP = "192.168.43.100"
 
+# Binary frame, little-endian. Must match PCARSForwarderLayout in telemetry_pcars.h.
+FRAME_MAGIC = 0x57464350    # "PCFW"
+FRAME_VERSION = 1
+FRAME_FORMAT = '<IBBHIfHbxff'   # magic, version, flags, sequence, timestamp ms, speed, rpm, gear, pad, fuel, lapTime
+
+def build_frame(sequence, telemetry_data):
+    """Pack telemetry into a binary frame followed by its CRC16-CCITT"""
+    body = struct.pack(FRAME_FORMAT,
+        FRAME_MAGIC,
+        FRAME_VERSION,
+        0,                                          # flags (reserved)
+        sequence & 0xFFFF,
+        int(time.time() * 1000) & 0xFFFFFFFF,       # sender wall clock, survives restarts
+        float(telemetry_data["speed"]),
+        int(telemetry_data["rpm"]) & 0xFFFF,
+        int(telemetry_data["gear"]),
+        float(telemetry_data["fuel"]),
+        float(telemetry_data["lapTime"])
+    )
+    return body + struct.pack('<H', binascii.crc_hqx(body, 0xFFFF))
+
 class PCARSForwarder:
-    def __init__(self, esp8266_ip, simulate_mode=False):
+    def __init__(self, esp8266_ip, simulate_mode=False, use_json=False):
         self.esp8266_ip = esp8266_ip
         self.simulate_mode = simulate_mode
+        self.use_json = use_json
+        self.sequence = 0
         self.running = False
         
         # Create UDP socket for sending to ESP8266
@@ -154,10 +181,14 @@ class PCARSForwarder:
         }
     
     def send_to_esp8266(self, telemetry_data):
-        """Send JSON telemetry data to ESP8266"""
+        """Send telemetry data to ESP8266 as a binary frame or JSON"""
         try:
-            json_data = json.dumps(telemetry_data)
-            self.esp8266_sock.sendto(json_data.encode('utf-8'), (self.esp8266_ip, ESP32_FORWARDER_PORT))
+            if self.use_json:
+                payload = json.dumps(telemetry_data).encode('utf-8')
+            else:
+                payload = build_frame(self.sequence, telemetry_data)
+                self.sequence += 1
+            self.esp8266_sock.sendto(payload, (self.esp8266_ip, ESP32_FORWARDER_PORT))
             return True
         except Exception as e:
             print(f"Error sending to ESP8266: {e}")
@@ -250,21 +281,25 @@ def main():
     # Parse command line arguments
     esp8266_ip = DEFAULT_ESP8266_IP
     simulate_mode = False
+    use_json = False
     
     for arg in sys.argv[1:]:
         if arg == "--simulate":
             simulate_mode = True
+        elif arg == "--json":
+            use_json = True
         elif not arg.startswith("--"):
             esp8266_ip = arg
     
     print("Project CARS 2 UDP Forwarder")
     print(f"Target ESP8266: {esp8266_ip}:{ESP32_FORWARDER_PORT}")
     print(f"Mode: {'Simulation' if simulate_mode else 'UDP Listening'}")
+    print(f"Format: {'JSON' if use_json else 'Binary frame'}")
     print("Press Ctrl+C to stop")
     print()
     
     # Create and start forwarder
-    forwarder = PCARSForwarder(esp8266_ip, simulate_mode)
+    forwarder = PCARSForwarder(esp8266_ip, simulate_mode, use_json)
     
     try:
         forwarder.start()
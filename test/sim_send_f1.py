@@ -26,13 +26,12 @@ DEFAULT_ESP8266_IP = "172.20.10.14"
 
 def create_packet_header(packet_id, session_time, frame_id, player_car_index=0):
     """Create F1 2020 packet header (24 bytes)"""
-    return struct.pack('<HBBBBBQfLBB',
+    return struct.pack('<HBBBBQfLBB',
         PACKET_FORMAT_2020,    # m_packetFormat (uint16)
         2,                     # m_gameMajorVersion (uint8)
         20,                    # m_gameMinorVersion (uint8)
         1,                     # m_packetVersion (uint8)
         packet_id,             # m_packetId (uint8)
-        0,                     # padding
         12345678901234567,     # m_sessionUID (uint64)
         session_time,          # m_sessionTime (float)
         frame_id,              # m_frameIdentifier (uint32)
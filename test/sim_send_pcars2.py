@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+Project CARS 2 UDP Telemetry Simulator
+Sends simulated PCARS2 binary packets (telemetry, timings, time stats) to the
+dashboard, as the game does with "UDP Protocol Version: Project CARS 2".
+
+Usage:
+    python sim_send_pcars2.py [ESP8266_IP]
+
+Default ESP8266 IP: 192.168.43.100 (adjust for your hotspot)
+"""
+
+import socket
+import struct
+import time
+import sys
+import math
+
+# PCARS2 UDP Configuration
+PCARS_UDP_PORT = 5606
+PACKET_TYPE_TELEMETRY = 0
+PACKET_TYPE_TIMINGS = 3
+PACKET_TYPE_TIME_STATS = 7
+MAX_PARTICIPANTS = 32
+
+# Packet sizes from SMS_UDP_Definitions.hpp
+TELEMETRY_SIZE = 559
+TIMINGS_SIZE = 1063
+TIME_STATS_SIZE = 1040
+
+PLAYER_INDEX = 0
+
+# Default ESP8266 IP (adjust for your network)
+DEFAULT_ESP8266_IP = "172.20.10.14"
+
+class PacketCounter:
+    """mPacketNumber counts every packet, mCategoryPacketNumber each type"""
+    def __init__(self):
+        self.total = 0
+        self.per_type = {}
+
+    def base(self, packet_type):
+        """Create PacketBase (12 bytes)"""
+        self.total += 1
+        self.per_type[packet_type] = self.per_type.get(packet_type, 0) + 1
+        return struct.pack('<IIBBBB',
+            self.total,                    # mPacketNumber (uint32)
+            self.per_type[packet_type],    # mCategoryPacketNumber (uint32)
+            1,                             # mPartialPacketIndex (uint8)
+            1,                             # mPartialPacketNumber (uint8)
+            packet_type,                   # mPacketType (uint8)
+            2                              # mPacketVersion (uint8)
+        )
+
+def pad(packet, size):
+    return packet + bytes(size - len(packet))
+
+def create_telemetry_packet(counter, speed_kmh, gear, rpm, fuel_level):
+    """Create sTelemetryData (559 bytes); only the fields up to sGearNumGears are filled"""
+    gear_value = 15 if gear < 0 else gear   # 15 = reverse
+    packet = counter.base(PACKET_TYPE_TELEMETRY)
+    packet += struct.pack('<bBBbBBhHhHHBBBBffHHbBBB',
+        PLAYER_INDEX,              # sViewedParticipantIndex (int8)
+        200, 0, 0, 0,              # sUnfilteredThrottle/Brake/Steering/Clutch
+        0,                         # sCarFlags (uint8)
+        95, 400, 90, 150, 300,     # Oil/water temperatures and pressures, fuel pressure
+        100,                       # sFuelCapacity (uint8, litres)
+        0, 200, 0,                 # sBrake, sThrottle, sClutch (uint8)
+        fuel_level,                # sFuelLevel (float, 0-1)
+        speed_kmh / 3.6,           # sSpeed (float, m/s)
+        rpm,                       # sRpm (uint16)
+        8000,                      # sMaxRpm (uint16)
+        0,                         # sSteering (int8)
+        gear_value | (6 << 4),     # sGearNumGears (uint8)
+        0,                         # sBoostAmount (uint8)
+        0                          # sCrashState (uint8)
+    )
+    return pad(packet, TELEMETRY_SIZE)
+
+def create_timings_packet(counter, position, lap, lap_time):
+    """Create sTimingsData (1063 bytes) with the player at PLAYER_INDEX"""
+    packet = counter.base(PACKET_TYPE_TIMINGS)
+    packet += struct.pack('<bIffff',
+        8,                         # sNumParticipants (int8)
+        0,                         # sParticipantsChangedTimestamp (uint32)
+        -1.0, 0.0, 0.0, 0.0        # sEventTimeRemaining, sSplitTimeAhead/Behind, sSplitTime
+    )
+    for i in range(MAX_PARTICIPANTS):
+        race_position = (position if i == PLAYER_INDEX else i + 2) | 0x80   # Top bit = active
+        packet += struct.pack('<3h3hHBBBBHBBffH',
+            0, 0, 0, 0, 0, 0,      # sWorldPosition[3], sOrientation[3]
+            0,                     # sCurrentLapDistance (uint16)
+            race_position,         # sRacePosition (uint8)
+            0, 0, 0,               # sSectorIndex, sHighestFlag, sPitModeSchedule
+            i,                     # sCarIndex (uint16)
+            0,                     # sRaceState (uint8)
+            lap,                   # sCurrentLap (uint8)
+            lap_time,              # sCurrentTime (float)
+            0.0,                   # sCurrentSectorTime (float)
+            0                      # sMPParticipantIndex (uint16)
+        )
+    packet += struct.pack('<HI',
+        PLAYER_INDEX,              # sLocalParticipantIndex (uint16)
+        0                          # sTickCount (uint32)
+    )
+    return pad(packet, TIMINGS_SIZE)
+
+def create_time_stats_packet(counter, last_lap_time):
+    """Create sTimeStatsData (1040 bytes)"""
+    packet = counter.base(PACKET_TYPE_TIME_STATS)
+    packet += struct.pack('<I', 0)  # sParticipantsChangedTimestamp (uint32)
+    for i in range(MAX_PARTICIPANTS):
+        packet += struct.pack('<ffffffIH2x',
+            last_lap_time,         # sFastestLapTime (float)
+            last_lap_time,         # sLastLapTime (float)
+            0.0, 0.0, 0.0, 0.0,    # sLastSectorTime, sFastestSector1/2/3Time
+            0,                     # sParticipantOnlineRep (uint32)
+            0                      # sMPParticipantIndex (uint16)
+        )
+    return pad(packet, TIME_STATS_SIZE)
+
+def simulate_driving_data(time_elapsed):
+    """Generate driving data based on time"""
+    lap_progress = (time_elapsed % 90.0) / 90.0  # 90-second lap
+    speed = max(50, 150 + 100 * math.sin(lap_progress * 2 * math.pi))
+    gear = min(6, 1 + int(speed / 50))
+    rpm = int(3000 + (speed % 50) / 50.0 * 5000)
+    fuel_level = max(0.0, 1.0 - time_elapsed / 1800.0)  # Empty after 30 minutes
+    return speed, gear, rpm, fuel_level
+
+def main():
+    # Get ESP8266 IP from command line or use default
+    esp8266_ip = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_ESP8266_IP
+
+    print(f"PCARS2 UDP Telemetry Simulator")
+    print(f"Target ESP8266: {esp8266_ip}:{PCARS_UDP_PORT}")
+    print(f"Press Ctrl+C to stop")
+    print()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    counter = PacketCounter()
+
+    try:
+        start_time = time.time()
+        tick = 0
+
+        while True:
+            elapsed_time = time.time() - start_time
+            speed, gear, rpm, fuel_level = simulate_driving_data(elapsed_time)
+            lap = 1 + int(elapsed_time / 90.0)
+
+            packets = [create_telemetry_packet(counter, speed, gear, rpm, fuel_level)]
+            # Timings at 5 Hz, time stats once a second
+            if tick % 4 == 0:
+                packets.append(create_timings_packet(counter, 3, lap, elapsed_time % 90.0))
+            if tick % 20 == 0:
+                packets.append(create_time_stats_packet(counter, 90.0 if lap > 1 else -1.0))
+
+            try:
+                for packet in packets:
+                    sock.sendto(packet, (esp8266_ip, PCARS_UDP_PORT))
+                print(f"Packet {counter.total:6d}: Speed={speed:6.1f} km/h, Gear={gear}, RPM={rpm:4d}, "
+                      f"Fuel={fuel_level * 100:5.1f}%, Lap={lap}")
+            except Exception as e:
+                print(f"Send error: {e}")
+
+            tick += 1
+            time.sleep(0.05)
+
+    except KeyboardInterrupt:
+        print("\nStopping simulator...")
+    finally:
+        sock.close()
+
+if __name__ == "__main__":
+    main()